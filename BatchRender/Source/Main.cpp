@@ -0,0 +1,417 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for the SimpleEQ batch renderer.
+
+    Runs SimpleEQAudioProcessor over many audio files without a host or GUI,
+    one processor per file and as many files at once as there are cores.
+
+    Usage: SimpleEQBatchRender --output <dir> [--preset preset.xml]
+                               [--lowcut-freq 80] [--lowcut-slope 24]
+                               [--peak-freq 750] [--peak-gain 0] [--peak-quality 1]
+                               [--highcut-freq 20000] [--highcut-slope 12]
+                               [--automation automation.csv]
+                               [--blocksize 65536] [--jobs <n>]
+                               [--trace trace.json] [--spike-threshold 0.5] <files or folders...>
+
+    --automation reads one change per line, "seconds, parameter ID, value"
+    with the value in the parameter's own units. The changes are queued with
+    their positions, so the render is the same whatever --blocksize is.
+
+    --trace writes every processBlock call as a Chrome / Perfetto trace, one
+    track per file. Callbacks using more than --spike-threshold of their
+    real-time budget are marked and counted.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+struct AutomationPoint
+{
+    double seconds{ 0.0 };
+    juce::String parameterID;
+    float value{ 0.f }; //real world value, like the other parameter options
+};
+
+struct RenderSettings
+{
+    juce::File outputDirectory;
+    juce::StringPairArray parameters; //parameter ID -> real world value
+    std::vector<AutomationPoint> automation; //in time order
+    int blockSize{ 65536 };
+    juce::File traceFile; //no tracing if this isn't set
+    double spikeThreshold{ 0.5 };
+    juce::int64 originTicks{ 0 }; //trace timestamps are relative to the start of the run
+};
+
+struct RenderTotals
+{
+    std::atomic<juce::int64> samplesRendered{ 0 }; //summed at 48k so files of any rate can share one counter
+    std::atomic<int> filesDone{ 0 }, filesFailed{ 0 };
+    std::atomic<juce::int64> spikes{ 0 };
+
+    juce::CriticalSection traceLock;
+    juce::Array<juce::var> traceEvents;
+    int nextTraceThread{ 1 };
+};
+
+/** Reads the PARAM children of an APVTS state file, the same XML the processor's state is made of. */
+static void readPreset(const juce::File& presetFile, juce::StringPairArray& parameters)
+{
+    auto xml = juce::parseXML(presetFile);
+    if (xml == nullptr)
+    {
+        std::cerr << "Couldn't read preset " << presetFile.getFullPathName() << std::endl;
+        return;
+    }
+
+    for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+        parameters.set(param->getStringAttribute("id"), param->getStringAttribute("value"));
+}
+
+/** Command line values win over the preset. Slopes are given in dB/oct and stored as choice indices. */
+static void readInlineParameters(const juce::ArgumentList& args, juce::StringPairArray& parameters)
+{
+    struct Option { const char* option; const char* parameterID; bool isSlope; };
+    const Option options[] = { { "--lowcut-freq",  "LowCut Freq",   false },
+                               { "--lowcut-slope", "LowCut Slope",  true },
+                               { "--peak-freq",    "Peak Freq",     false },
+                               { "--peak-gain",    "Peak Gain",     false },
+                               { "--peak-quality", "Peak Quality",  false },
+                               { "--highcut-freq", "HighCut Freq",  false },
+                               { "--highcut-slope", "HighCut Slope", true } };
+
+    for (auto& o : options)
+    {
+        if (! args.containsOption(o.option))
+            continue;
+
+        auto value = args.getValueForOption(o.option).getFloatValue();
+        if (o.isSlope)
+            value = (float) juce::jlimit((int) Slope_12, (int) Slope_48, juce::roundToInt(value / 12.f) - 1); //12 db/Oct -> Slope_12 etc.
+
+        parameters.set(o.parameterID, juce::String(value));
+    }
+}
+
+/** "seconds, parameter ID, value" per line, blank lines and lines starting with # are skipped. */
+static void readAutomation(const juce::File& automationFile, std::vector<AutomationPoint>& automation)
+{
+    juce::StringArray lines;
+    automationFile.readLines(lines);
+
+    for (auto& line : lines)
+    {
+        const auto trimmed = line.trim();
+        if (trimmed.isEmpty() || trimmed.startsWithChar('#'))
+            continue;
+
+        const auto fields = juce::StringArray::fromTokens(trimmed, ",", "\"");
+        if (fields.size() != 3)
+        {
+            std::cerr << "Skipping automation line \"" << trimmed << "\"" << std::endl;
+            continue;
+        }
+
+        automation.push_back({ fields[0].trim().getDoubleValue(), fields[1].trim().unquoted(), fields[2].trim().getFloatValue() });
+    }
+
+    std::stable_sort(automation.begin(), automation.end(), [](const AutomationPoint& a, const AutomationPoint& b) { return a.seconds < b.seconds; });
+}
+
+static void applyParameters(SimpleEQAudioProcessor& processor, const juce::StringPairArray& parameters)
+{
+    for (auto& id : parameters.getAllKeys())
+    {
+        if (auto* parameter = processor.apvts.getParameter(id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(parameters[id].getFloatValue()));
+        else
+            std::cerr << "Unknown parameter " << id << std::endl;
+    }
+}
+
+//==============================================================================
+class RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(const juce::File& in, const RenderSettings& s, RenderTotals& t)
+        : juce::ThreadPoolJob(in.getFileName()), input(in), settings(s), totals(t) {}
+
+    JobStatus runJob() override
+    {
+        if (render())
+            ++totals.filesDone;
+        else
+            ++totals.filesFailed;
+
+        return jobHasFinished;
+    }
+
+private:
+    std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormatManager& formats)
+    {
+        if (input.hasFileExtension("wav")) //wav can be mapped straight into memory, no copying through a stream
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(juce::WavAudioFormat().createMemoryMappedReader(input));
+            if (mapped != nullptr && mapped->mapEntireFile())
+                return mapped;
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(input));
+    }
+
+    bool render()
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        auto reader = createReader(formats);
+        auto* format = formats.findFormatForFileExtension(input.getFileExtension());
+        if (reader == nullptr || format == nullptr)
+            return fail("can't read this file");
+
+        const auto numChannels = (int) reader->numChannels;
+        if (numChannels < 1 || numChannels > SimpleEQAudioProcessor::maxNumChannels)
+            return fail("unsupported channel count");
+
+        const auto outputFile = settings.outputDirectory.getChildFile(input.getFileName());
+        if (outputFile == input)
+            return fail("output would overwrite the input");
+
+        outputFile.deleteFile();
+        auto stream = outputFile.createOutputStream();
+        if (stream == nullptr)
+            return fail("can't write " + outputFile.getFullPathName());
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader->sampleRate, (unsigned int) numChannels,
+                                                                                (int) reader->bitsPerSample, reader->metadataValues, 0));
+        if (writer == nullptr)
+            return fail("can't create a writer for this format");
+        stream.release(); //the writer owns it now
+
+        SimpleEQAudioProcessor processor; //no editor is ever created
+        processor.setParallelChannelThreshold(SimpleEQAudioProcessor::maxNumChannels + 1); //the files are already spread over the cores
+        processor.setNonRealtime(true); //coefficients get designed inline, so the render is deterministic
+
+        const auto layout = numChannels == 1 ? juce::AudioChannelSet::mono()
+                          : numChannels == 2 ? juce::AudioChannelSet::stereo()
+                                             : juce::AudioChannelSet::discreteChannels(numChannels);
+        auto buses = processor.getBusesLayout(); //only the main buses change, the sidechain stays off
+        buses.inputBuses.getReference(0) = layout;
+        buses.outputBuses.getReference(0) = layout;
+        if (! processor.setBusesLayout(buses))
+            return fail("layout refused by the processor");
+
+        auto& monitor = processor.getPerformanceMonitor();
+        monitor.setSpikeThreshold(settings.spikeThreshold);
+
+        applyParameters(processor, settings.parameters);
+        processor.setRateAndBufferSizeDetails(reader->sampleRate, settings.blockSize);
+        processor.prepareToPlay(reader->sampleRate, settings.blockSize);
+
+        juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+        juce::MidiBuffer midi;
+
+        const auto events = getParameterEvents(processor, reader->sampleRate);
+        size_t nextEvent = 0;
+
+        //linear phase and oversampling delay the output by the latency they report. The first that many samples out are
+        //dropped and the input is followed by as much silence, so the file lines up with the input and keeps its tail.
+        //Positions, the automation's included, count input samples, which is also what the processor counts. It's the
+        //latency the starting parameters give, automating Linear Phase or Oversampling to another one isn't compensated
+        const auto latency = (juce::int64) processor.getLatencySamples();
+        const auto lengthToProcess = reader->lengthInSamples + latency;
+        auto samplesToDrop = latency;
+        if (settings.traceFile != juce::File())
+            monitor.enableTracing((int) (lengthToProcess / settings.blockSize) + 1);
+
+        for (juce::int64 position = 0; position < lengthToProcess && ! shouldExit();)
+        {
+            auto numSamples = (int) juce::jmin((juce::int64) settings.blockSize, lengthToProcess - position);
+
+            //the automation inside this block goes to the processor with its position, a full queue ends the block early
+            for (; nextEvent < events.size() && events[nextEvent].samplePosition < position + numSamples; ++nextEvent)
+            {
+                const auto& event = events[nextEvent];
+                if (! processor.queueParameterChange(event.parameterIndex, event.value, event.samplePosition))
+                {
+                    const auto eventStep = event.samplePosition - event.samplePosition % SimpleEQAudioProcessor::parameterEventGrid;
+                    numSamples = (int) juce::jmax((juce::int64) 1, eventStep - position); //the queue is empty again by the next block
+                    break;
+                }
+            }
+
+            buffer.setSize(numChannels, numSamples, false, false, true); //never reallocates, the buffer only shrinks for the last block
+
+            const auto numInputSamples = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, reader->lengthInSamples - position);
+            if (numInputSamples < numSamples) //past the end of the input, the latency's worth of tail comes out of silence
+                buffer.clear(numInputSamples, numSamples - numInputSamples);
+            if (numInputSamples > 0)
+                reader->read(&buffer, 0, numInputSamples, position, true, true);
+            processor.processBlock(buffer, midi);
+
+            const auto numDropped = (int) juce::jmin((juce::int64) numSamples, samplesToDrop);
+            samplesToDrop -= numDropped;
+            if (numDropped < numSamples && ! writer->writeFromAudioSampleBuffer(buffer, numDropped, numSamples - numDropped))
+                return fail("write failed");
+
+            position += numSamples;
+        }
+
+        processor.releaseResources();
+        totals.spikes += (juce::int64) monitor.getNumSpikes();
+        if (settings.traceFile != juce::File())
+            addTrace(monitor);
+
+        totals.samplesRendered += (juce::int64) ((double) reader->lengthInSamples * 48000.0 / reader->sampleRate);
+        return true;
+    }
+
+    /** The automation as the processor's events, at this file's sample rate. Values stay in real world units, the processor converts them. */
+    std::vector<ParameterEvent> getParameterEvents(SimpleEQAudioProcessor& processor, double sampleRate) const
+    {
+        std::vector<ParameterEvent> events;
+        const auto& parameters = processor.getParameters();
+
+        for (auto& point : settings.automation)
+        {
+            auto index = -1;
+            for (int i = 0; i < parameters.size() && index < 0; ++i)
+                if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameters[i]); withID != nullptr && withID->paramID == point.parameterID)
+                    index = i;
+
+            if (index < 0)
+                std::cerr << "Unknown automated parameter " << point.parameterID << std::endl;
+            else
+                events.push_back({ (juce::int64) std::llround(point.seconds * sampleRate), index, point.value });
+        }
+
+        return events;
+    }
+
+    void addTrace(const PerformanceMonitor& monitor)
+    {
+        const juce::ScopedLock sl(totals.traceLock);
+        const auto threadId = totals.nextTraceThread++;
+
+        //names the track after the file
+        auto* args = new juce::DynamicObject();
+        args->setProperty("name", input.getFileName());
+        auto* metadata = new juce::DynamicObject();
+        metadata->setProperty("name", "thread_name");
+        metadata->setProperty("ph", "M");
+        metadata->setProperty("pid", 1);
+        metadata->setProperty("tid", threadId);
+        metadata->setProperty("args", juce::var(args));
+        totals.traceEvents.add(juce::var(metadata));
+
+        totals.traceEvents.addArray(monitor.getChromeTraceEvents(threadId, settings.originTicks));
+    }
+
+    bool fail(const juce::String& reason)
+    {
+        std::cerr << input.getFullPathName() << ": " << reason << std::endl;
+        return false;
+    }
+
+    juce::File input;
+    const RenderSettings& settings;
+    RenderTotals& totals;
+};
+
+//==============================================================================
+static juce::Array<juce::File> collectInputs(const juce::ArgumentList& args)
+{
+    static const juce::StringArray optionsWithValues{ "--output", "--preset", "--lowcut-freq", "--lowcut-slope", "--peak-freq", "--peak-gain",
+                                                      "--peak-quality", "--highcut-freq", "--highcut-slope", "--blocksize", "--jobs",
+                                                      "--trace", "--spike-threshold", "--automation" };
+    juce::Array<juce::File> inputs;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        auto& arg = args[i];
+        if (arg.isOption())
+        {
+            if (optionsWithValues.contains(arg.text))
+                ++i; //skip the value
+            continue;
+        }
+
+        auto file = arg.resolveAsFile();
+        if (file.isDirectory())
+            inputs.addArray(file.findChildFiles(juce::File::findFiles, true, "*.wav;*.flac"));
+        else if (file.existsAsFile())
+            inputs.add(file);
+    }
+
+    return inputs;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; //the APVTS needs a message manager, no window is ever opened
+    juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--output"))
+    {
+        std::cerr << "Usage: SimpleEQBatchRender --output <dir> [--preset preset.xml] [parameter options] <files or folders...>" << std::endl;
+        return 1;
+    }
+
+    RenderSettings settings;
+    settings.outputDirectory = args.getFileForOption ("--output");
+    settings.outputDirectory.createDirectory();
+
+    if (args.containsOption ("--blocksize"))
+        settings.blockSize = juce::jmax (16, args.getValueForOption ("--blocksize").getIntValue());
+
+    if (args.containsOption ("--preset"))
+        readPreset (args.getExistingFileForOption ("--preset"), settings.parameters);
+    readInlineParameters (args, settings.parameters);
+
+    if (args.containsOption ("--automation"))
+        readAutomation (args.getExistingFileForOption ("--automation"), settings.automation);
+
+    if (args.containsOption ("--trace"))
+        settings.traceFile = args.getFileForOption ("--trace");
+    if (args.containsOption ("--spike-threshold"))
+        settings.spikeThreshold = args.getValueForOption ("--spike-threshold").getDoubleValue();
+    settings.originTicks = juce::Time::getHighResolutionTicks();
+
+    const auto inputs = collectInputs (args);
+    const auto numJobs = args.containsOption ("--jobs") ? juce::jmax (1, args.getValueForOption ("--jobs").getIntValue())
+                                                        : juce::SystemStats::getNumCpus();
+
+    RenderTotals totals;
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    {
+        juce::ThreadPool pool (numJobs);
+        for (auto& input : inputs)
+            pool.addJob (new RenderJob (input, settings, totals), true);
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep (50);
+    }
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+    const auto hoursOfAudio = (double) totals.samplesRendered.load() / 48000.0 / 3600.0;
+
+    std::cout << totals.filesDone.load() << " files rendered, " << totals.filesFailed.load() << " failed" << std::endl
+              << hoursOfAudio << " hours of audio in " << seconds << " s ("
+              << hoursOfAudio / juce::jmax (seconds, 0.001) << " hours of audio per second)" << std::endl
+              << totals.spikes.load() << " callbacks over " << settings.spikeThreshold * 100.0 << "% of their budget" << std::endl;
+
+    if (settings.traceFile != juce::File())
+    {
+        juce::DynamicObject::Ptr trace = new juce::DynamicObject();
+        trace->setProperty ("traceEvents", totals.traceEvents);
+        trace->setProperty ("displayTimeUnit", "ms");
+
+        if (! settings.traceFile.replaceWithText (juce::JSON::toString (juce::var (trace.get()), true)))
+            std::cerr << "Couldn't write " << settings.traceFile.getFullPathName() << std::endl;
+    }
+
+    return totals.filesFailed.load() > 0 ? 1 : 0;
+}
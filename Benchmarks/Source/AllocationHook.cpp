@@ -0,0 +1,31 @@
+/*
+  ==============================================================================
+
+    AllocationHook.cpp
+
+    The benchmarks' own operator new, which tells RealtimeCounters about every
+    allocation so an allocation inside processBlock shows up in the counters.
+    It lives here rather than in the plugin's sources because replacing the
+    global operator new takes over allocation for the whole binary, which is
+    fine for a harness that owns its process and not for a plugin in a host.
+
+  ==============================================================================
+*/
+
+#include "../../Source/RealtimeCounters.h"
+
+void* operator new(std::size_t size)
+{
+    RealtimeCounters::countAllocation(); //only counts while a ScopedAllocationCounting is around
+
+    if (auto* memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
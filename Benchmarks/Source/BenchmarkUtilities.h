@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    BenchmarkUtilities.h
+
+    Helpers shared by the benchmark reports: setting up a processor for a
+    given layout and timing processBlock on it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+namespace Benchmark
+{
+    /** Puts the processor into an n channel layout and prepares it. Returns false if the layout was refused. */
+    inline bool prepareProcessor(SimpleEQAudioProcessor& processor, int numChannels, double sampleRate, int blockSize)
+    {
+        auto layout = processor.getBusesLayout(); //only the main buses change, the sidechain stays off
+        const auto channelSet = numChannels == 1 ? juce::AudioChannelSet::mono()
+                              : numChannels == 2 ? juce::AudioChannelSet::stereo()
+                                                 : juce::AudioChannelSet::discreteChannels(numChannels);
+        layout.inputBuses.getReference(0) = channelSet;
+        layout.outputBuses.getReference(0) = channelSet;
+
+        if (! processor.setBusesLayout(layout))
+            return false;
+
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        return true;
+    }
+
+    /** Sets a parameter from its real world value, e.g. setParameter(p, "LowCut Slope", 3). */
+    inline void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    inline void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+    }
+
+    /** Runs processBlock numBlocks times on a copy of the noise and returns the average nanoseconds per block.
+        Allocations inside the timed callbacks are reported, AllocationHook.cpp counts them while main() has counting on.
+    */
+    inline double timeProcessBlock(SimpleEQAudioProcessor& processor, const juce::AudioBuffer<float>& noise, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer(noise.getNumChannels(), noise.getNumSamples());
+        juce::MidiBuffer midi;
+        juce::int64 totalTicks = 0;
+
+        for (int warmUp = 0; warmUp < 16; ++warmUp) //lets the coefficients settle and the caches warm up
+        {
+            buffer.makeCopyOf(noise, true);
+            processor.processBlock(buffer, midi);
+        }
+
+        const auto allocationsBefore = processor.getRealtimeCounters().allocations.load();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf(noise, true); //the copy isn't timed, only the callback is
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            totalTicks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        if (const auto allocated = processor.getRealtimeCounters().allocations.load() - allocationsBefore; allocated > 0)
+            std::cerr << "warning: " << allocated << " allocations inside processBlock" << std::endl;
+
+        return juce::Time::highResolutionTicksToSeconds(totalTicks) * 1.0e9 / numBlocks;
+    }
+}
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    ChannelScaling.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelScaling.h"
+#include "BenchmarkUtilities.h"
+
+namespace Benchmark
+{
+    static double timeLayout(int numChannels, bool parallel, double sampleRate, int blockSize, int numBlocks)
+    {
+        SimpleEQAudioProcessor processor;
+        processor.setParallelChannelThreshold(parallel ? 1 : SimpleEQAudioProcessor::maxNumChannels + 1);
+
+        setParameter(processor, "LowCut Freq", 80.f); //every stage active, the worst case
+        setParameter(processor, "LowCut Slope", Slope_48);
+        setParameter(processor, "Peak Gain", 6.f);
+        setParameter(processor, "HighCut Freq", 12000.f);
+        setParameter(processor, "HighCut Slope", Slope_48);
+
+        if (! prepareProcessor(processor, numChannels, sampleRate, blockSize))
+            return -1.0;
+
+        juce::AudioBuffer<float> noise(numChannels, blockSize);
+        juce::Random random(numChannels);
+        fillWithNoise(noise, random);
+
+        return timeProcessBlock(processor, noise, numBlocks);
+    }
+
+    juce::var runChannelScalingReport(double sampleRate, int blockSize, int numBlocks)
+    {
+        juce::Array<juce::var> results;
+        std::cout << "channels  serial ns/sample/ch  parallel ns/sample/ch" << std::endl;
+
+        for (int numChannels = 1; numChannels <= SimpleEQAudioProcessor::maxNumChannels; numChannels = numChannels < 16 ? numChannels + 1 : numChannels * 2)
+        {
+            const auto samples = (double) blockSize * numChannels;
+            const auto serial = timeLayout(numChannels, false, sampleRate, blockSize, numBlocks) / samples;
+            const auto parallel = timeLayout(numChannels, true, sampleRate, blockSize, numBlocks) / samples;
+
+            std::cout << juce::String(numChannels).paddedLeft(' ', 8)
+                      << juce::String(serial, 3).paddedLeft(' ', 21)
+                      << juce::String(parallel, 3).paddedLeft(' ', 23) << std::endl;
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("channels", numChannels);
+            result->setProperty("serialNsPerSamplePerChannel", serial);
+            result->setProperty("parallelNsPerSamplePerChannel", parallel);
+            results.add(juce::var(result));
+        }
+
+        return results;
+    }
+
+    static juce::var timeIdleSession(int numInstances, bool atDefaults, double sampleRate, int blockSize, int numBlocks)
+    {
+        juce::OwnedArray<SimpleEQAudioProcessor> instances;
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto* instance = instances.add(new SimpleEQAudioProcessor());
+            if (! atDefaults)
+            {
+                setParameter(*instance, "LowCut Freq", 80.f);
+                setParameter(*instance, "Peak Gain", 3.f);
+            }
+
+            if (! prepareProcessor(*instance, 2, sampleRate, blockSize))
+                return {};
+        }
+
+        juce::AudioBuffer<float> noise(2, blockSize), silence(2, blockSize);
+        juce::Random random(1);
+        fillWithNoise(noise, random);
+        silence.clear();
+
+        auto timeSession = [&](const juce::AudioBuffer<float>& input)
+        {
+            auto total = 0.0;
+            for (auto* instance : instances)
+                total += timeProcessBlock(*instance, input, numBlocks);
+            return total;
+        };
+
+        const auto noiseNs = timeSession(noise);
+        const auto silenceNs = timeSession(silence); //the warm up inside runs the tails out, so every instance is idle by the time it's timed
+        const auto budgetNs = blockSize / sampleRate * 1.0e9;
+
+        std::cout << (atDefaults ? "  defaults" : "  active EQ") << ": noise " << juce::String(noiseNs * 100.0 / budgetNs, 2)
+                  << "% CPU, silence " << juce::String(silenceNs * 100.0 / budgetNs, 2) << "% CPU" << std::endl;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("atDefaults", atDefaults);
+        result->setProperty("noiseNsPerBlock", noiseNs);
+        result->setProperty("silenceNsPerBlock", silenceNs);
+        return juce::var(result);
+    }
+
+    juce::var runIdleSessionReport(int numInstances, double sampleRate, int blockSize, int numBlocks)
+    {
+        std::cout << numInstances << " stereo instances, share of one core for the whole session" << std::endl;
+
+        juce::Array<juce::var> results;
+        results.add(timeIdleSession(numInstances, true, sampleRate, blockSize, numBlocks)); //every stage is identity
+        results.add(timeIdleSession(numInstances, false, sampleRate, blockSize, numBlocks)); //only silence lets these skip
+        return results;
+    }
+
+    static juce::var timeOversampling(const juce::String& name, int choice, double sampleRate, int blockSize, int numBlocks)
+    {
+        SimpleEQAudioProcessor processor;
+        setParameter(processor, "LowCut Freq", 80.f);
+        setParameter(processor, "LowCut Slope", Slope_24);
+        setParameter(processor, "Peak Freq", 15000.f); //well inside the cramped region at 44.1 or 48 kHz
+        setParameter(processor, "Peak Gain", 6.f);
+        setParameter(processor, "Band 2 Enabled", 1.f);
+        setParameter(processor, "Band 2 Gain", -3.f);
+        setParameter(processor, "Oversampling", (float) choice);
+
+        if (! prepareProcessor(processor, 2, sampleRate, blockSize))
+            return {};
+
+        juce::AudioBuffer<float> noise(2, blockSize);
+        juce::Random random(1);
+        fillWithNoise(noise, random);
+
+        const auto nsPerSecond = timeProcessBlock(processor, noise, numBlocks) / blockSize * sampleRate; //per second of audio, whatever the rate
+        std::cout << name.paddedRight(' ', 20) << juce::String(nsPerSecond * 1.0e-7, 3).paddedLeft(' ', 10) << "% CPU"
+                  << "   latency " << processor.getLatencySamples() << " samples" << std::endl;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("sampleRate", sampleRate);
+        result->setProperty("nsPerSecondOfAudio", nsPerSecond);
+        result->setProperty("latencySamples", processor.getLatencySamples());
+        return juce::var(result);
+    }
+
+    juce::var runOversamplingReport(double sampleRate, int blockSize, int numBlocks)
+    {
+        std::cout << "stereo, peak at 15 kHz, share of one core" << std::endl;
+
+        juce::Array<juce::var> results;
+        results.add(timeOversampling("off", 0, sampleRate, blockSize, numBlocks));
+        results.add(timeOversampling("2x", 1, sampleRate, blockSize, numBlocks));
+        results.add(timeOversampling("4x", 2, sampleRate, blockSize, numBlocks));
+        results.add(timeOversampling("8x", 3, sampleRate, blockSize, numBlocks));
+        results.add(timeOversampling("off, 4x sample rate", 0, sampleRate * 4.0, blockSize * 4, numBlocks)); //the same audio in the same number of callbacks
+        return results;
+    }
+}
@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    ChannelScaling.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Benchmark
+{
+    /** Times processBlock for 1 to 64 channels, serial and with the worker pool,
+        and returns the cost per channel as a JSON array.
+    */
+    juce::var runChannelScalingReport(double sampleRate, int blockSize, int numBlocks);
+
+    /** Times a session of stereo instances, left at their defaults and with an active EQ,
+        on noise and on digital silence. The silent runs should cost next to nothing.
+    */
+    juce::var runIdleSessionReport(int numInstances, double sampleRate, int blockSize, int numBlocks);
+
+    /** Times a stereo instance with a band up in the cramped region at each oversampling factor, and with
+        oversampling off at four times the rate, the old workaround. Costs are per second of audio.
+    */
+    juce::var runOversamplingReport(double sampleRate, int blockSize, int numBlocks);
+}
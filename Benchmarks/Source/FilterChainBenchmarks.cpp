@@ -0,0 +1,361 @@
+/*
+  ==============================================================================
+
+    FilterChainBenchmarks.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterChainBenchmarks.h"
+#include "../../Source/FilterChain.h"
+#include "../../Source/ChannelGroupChain.h"
+#include "../../Source/ResponseCurve.h"
+#include "../../Source/SvfChain.h"
+#include "../../Source/DynamicPeak.h"
+
+namespace Benchmark
+{
+    static const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    static const double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0, 384000.0 };
+    static const int slopes[] = { Slope_12, Slope_24, Slope_36, Slope_48 };
+
+    static ChainSettings makeSettings(int slope)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.highCutFreq = 12000.f;
+        settings.bands[0] = { true, Band_Peak, 750.f, 6.f, 1.f };
+        settings.lowCutSlope = slope;
+        settings.highCutSlope = slope;
+        return settings;
+    }
+
+    //both cuts parked at the ends of their ranges, so every stage that runs is a band
+    static ChainSettings makeBandsOnlySettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = minCutFrequency;
+        settings.highCutFreq = maxCutFrequency;
+
+        //a cut left in the chain would be timed along with the bands, so check it's out at every rate
+        for (auto sampleRate : sampleRates)
+        {
+            const auto coefficients = makeChainCoefficients(settings, sampleRate);
+            if (coefficients.lowCutSlope != Slope_Off || coefficients.highCutSlope != Slope_Off)
+                std::cerr << "warning: parked cuts still in the chain at " << sampleRate << " Hz" << std::endl;
+        }
+
+        return settings;
+    }
+
+    static void loadSettings(MonoChain& chain, const ChainSettings& settings, double sampleRate)
+    {
+        updateCoefficients(chain.get<ChainPosition::Peak>().coefficients, makeBandFilter(settings.bands[0], sampleRate));
+        updateCutFilter(chain.get<ChainPosition::LowCut>(), makeLowCutFilter(settings, sampleRate), settings.lowCutSlope);
+        updateCutFilter(chain.get<ChainPosition::HighCut>(), makeHighCutFilter(settings, sampleRate), settings.highCutSlope);
+    }
+
+    template <typename ProcessFunction>
+    static double timeBlocks(int blockSize, int samplesPerMeasurement, ProcessFunction&& processBlock)
+    {
+        juce::AudioBuffer<float> buffer(1, blockSize);
+        juce::Random random(blockSize);
+        for (int i = 0; i < blockSize; ++i)
+            buffer.setSample(0, i, random.nextFloat() * 2.f - 1.f);
+
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        const auto numBlocks = juce::jmax(1, samplesPerMeasurement / blockSize);
+        for (int i = 0; i < 8; ++i) //warm up
+            processBlock(block);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numBlocks; ++i)
+            processBlock(block); //the signal keeps running through the filters, ScopedNoDenormals keeps the tail cheap
+        const auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / ((double) numBlocks * blockSize);
+    }
+
+    static double timeMonoChain(int slope, int blockSize, double sampleRate, int samplesPerMeasurement)
+    {
+        MonoChain chain; //juce::dsp::ProcessorChain with bypassable CutFilter stages
+        prepareChain(chain, { sampleRate, (juce::uint32) blockSize, 1 });
+        loadSettings(chain, makeSettings(slope), sampleRate);
+
+        return timeBlocks(blockSize, samplesPerMeasurement, [&chain](juce::dsp::AudioBlock<float>& block)
+        {
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            chain.process(context);
+        });
+    }
+
+    static double timeChannelGroup(ChainKernel kernel, int slope, int blockSize, double sampleRate, int samplesPerMeasurement)
+    {
+        ScalarChannelGroup chain; //what the processor runs, one unrolled cascade per slope
+        chain.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+        chain.setKernel(kernel);
+        chain.apply(makeChainCoefficients(makeSettings(slope), sampleRate));
+
+        return timeBlocks(blockSize, samplesPerMeasurement, [&chain](juce::dsp::AudioBlock<float>& block) { chain.process(block); });
+    }
+
+    static juce::var makeResult(const juce::String& chainName, int slope, double sampleRate, int blockSize, double nsPerSample, int passesOverBuffer)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", chainName + "/" + juce::String(12 * (slope + 1)) + "dB/" + juce::String(sampleRate, 0) + "/" + juce::String(blockSize));
+        result->setProperty("slopeDbPerOct", 12 * (slope + 1));
+        result->setProperty("sampleRate", sampleRate);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("nsPerSample", nsPerSample);
+        result->setProperty("passesOverBuffer", passesOverBuffer); //each pass reads and writes the whole block once
+        result->setProperty("bytesMovedPerSample", passesOverBuffer * 2 * (int) sizeof(float));
+        return juce::var(result);
+    }
+
+    juce::var runFilterChainBenchmarks(int samplesPerMeasurement)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        juce::Array<juce::var> results;
+
+        for (auto slope : slopes)
+        {
+            for (auto sampleRate : sampleRates)
+            {
+                for (auto blockSize : blockSizes)
+                {
+                    const auto numStages = 2 * (slope + 1) + 1;
+                    results.add(makeResult("MonoChain", slope, sampleRate, blockSize, timeMonoChain(slope, blockSize, sampleRate, samplesPerMeasurement), numStages));
+                    results.add(makeResult("CutCascadeChain", slope, sampleRate, blockSize,
+                                           timeChannelGroup(ChainKernel::processorChain, slope, blockSize, sampleRate, samplesPerMeasurement), numStages));
+                    results.add(makeResult("FusedChain", slope, sampleRate, blockSize,
+                                           timeChannelGroup(ChainKernel::fused, slope, blockSize, sampleRate, samplesPerMeasurement), 1));
+                    results.add(makeResult("FusedPipelinedChain", slope, sampleRate, blockSize,
+                                           timeChannelGroup(ChainKernel::fusedPipelined, slope, blockSize, sampleRate, samplesPerMeasurement), 1));
+                }
+            }
+
+            std::cout << "Filter chains " << 12 * (slope + 1) << " dB/oct done" << std::endl;
+        }
+
+        return results;
+    }
+
+    juce::var runBandScalingBenchmarks(int samplesPerMeasurement)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        juce::Array<juce::var> results;
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        const std::pair<ChainKernel, const char*> kernels[] = { { ChainKernel::processorChain, "CutCascadeChain" },
+                                                                { ChainKernel::fused, "FusedChain" },
+                                                                { ChainKernel::fusedPipelined, "FusedPipelinedChain" } };
+
+        std::cout << "bands";
+        for (auto& kernel : kernels)
+            std::cout << "  " << kernel.second << " ns/sample";
+        std::cout << std::endl;
+
+        for (auto numBands : { 0, 1, 2, 4, 8, 16, 24, 32 })
+        {
+            auto settings = makeBandsOnlySettings();
+            for (int band = 0; band < numBands; ++band)
+                settings.bands[(size_t) band] = { true, band % 4 == 3 ? Band_Notch : Band_Peak, 40.f * std::pow(1.2f, (float) band), 3.f, 2.f };
+            const auto coefficients = makeChainCoefficients(settings, sampleRate);
+
+            std::cout << juce::String(numBands).paddedLeft(' ', 5);
+            for (auto& kernel : kernels)
+            {
+                ScalarChannelGroup chain;
+                chain.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+                chain.setKernel(kernel.first);
+                chain.apply(coefficients);
+                const auto nsPerSample = timeBlocks(blockSize, samplesPerMeasurement, [&chain](juce::dsp::AudioBlock<float>& block) { chain.process(block); });
+
+                auto* result = new juce::DynamicObject();
+                result->setProperty("name", juce::String(kernel.second) + "/" + juce::String(numBands) + " bands");
+                result->setProperty("bands", numBands);
+                result->setProperty("nsPerSample", nsPerSample);
+                results.add(juce::var(result));
+                std::cout << juce::String(nsPerSample, 2).paddedLeft(' ', juce::String(kernel.second).length() + 12);
+            }
+            std::cout << std::endl;
+        }
+
+        return results;
+    }
+
+    template <typename GroupType>
+    static double timeBandsWithKernel(KernelIsa isa, const ChainCoefficients& coefficients, int samplesPerMeasurement)
+    {
+        GroupType chain;
+        chain.prepare({ 48000.0, 512, 1 });
+        chain.setBiquadKernel(BiquadKernels::get(isa));
+        chain.apply(coefficients); //processorChain kernel, so the bands go through BandCascade's skewed kernel
+        return timeBlocks(512, samplesPerMeasurement, [&chain](juce::dsp::AudioBlock<float>& block) { chain.process(block); });
+    }
+
+    juce::var runKernelIsaBenchmarks(int samplesPerMeasurement)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        juce::Array<juce::var> results;
+        std::cout << BiquadKernels::getSelfTestReport()
+                  << "selected: " << BiquadKernels::getName(BiquadKernels::getSelected()) << std::endl
+                  << "isa      bands  ScalarChannelGroup ns/sample  SIMDChannelGroup ns/sample" << std::endl;
+
+        for (int isa = 0; isa < (int) KernelIsa::numIsas; ++isa)
+        {
+            if (! BiquadKernels::isSupported((KernelIsa) isa))
+                continue;
+
+            for (auto numBands : { 8, 32 })
+            {
+                auto settings = makeBandsOnlySettings();
+                for (int band = 0; band < numBands; ++band)
+                    settings.bands[(size_t) band] = { true, Band_Peak, 40.f * std::pow(1.2f, (float) band), 3.f, 2.f };
+                const auto coefficients = makeChainCoefficients(settings, 48000.0);
+
+                const auto scalarGroup = timeBandsWithKernel<ScalarChannelGroup>((KernelIsa) isa, coefficients, samplesPerMeasurement);
+                const auto simdGroup = timeBandsWithKernel<SIMDChannelGroup>((KernelIsa) isa, coefficients, samplesPerMeasurement);
+
+                auto* result = new juce::DynamicObject();
+                result->setProperty("name", juce::String(BiquadKernels::getName((KernelIsa) isa)) + "/" + juce::String(numBands) + " bands");
+                result->setProperty("isa", BiquadKernels::getName((KernelIsa) isa));
+                result->setProperty("bands", numBands);
+                result->setProperty("scalarGroupNsPerSample", scalarGroup);
+                result->setProperty("simdGroupNsPerSample", simdGroup);
+                results.add(juce::var(result));
+
+                std::cout << juce::String(BiquadKernels::getName((KernelIsa) isa)).paddedRight(' ', 9) << juce::String(numBands).paddedLeft(' ', 5)
+                          << juce::String(scalarGroup, 2).paddedLeft(' ', 30) << juce::String(simdGroup, 2).paddedLeft(' ', 28) << std::endl;
+            }
+        }
+
+        return results;
+    }
+
+    juce::var runDynamicPeakBenchmarks(int samplesPerMeasurement)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        juce::Array<juce::var> results;
+        constexpr double sampleRate = 48000.0;
+        const BandSettings band{ true, Band_Peak, 750.f, 6.f, 1.f };
+
+        std::cout << "blocksize  static Peak ns/sample  dynamic Peak ns/sample  ratio" << std::endl;
+        for (auto blockSize : { 32, 512 })
+        {
+            Filter peak; //the MonoChain's Peak stage
+            prepareAsBiquads(peak);
+            peak.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+            updateCoefficients(peak.coefficients, makeBandFilter(band, sampleRate));
+            const auto staticNs = timeBlocks(blockSize, samplesPerMeasurement, [&peak](juce::dsp::AudioBlock<float>& block)
+            {
+                juce::dsp::ProcessContextReplacing<float> context(block);
+                peak.process(context);
+            });
+
+            //the noise is far above the threshold, so the bell is cutting and moving the whole time
+            DynamicSettings dynamics;
+            dynamics.enabled = true;
+            dynamics.thresholdInDecibels = -40.f;
+            DynamicPeak dynamicPeak;
+            dynamicPeak.prepare(sampleRate, 1);
+            const auto dynamicNs = timeBlocks(blockSize, samplesPerMeasurement, [&](juce::dsp::AudioBlock<float>& block)
+            {
+                dynamicPeak.setParameters(band.freq, band.quality, dynamics);
+                dynamicPeak.process(block, block); //keyed by its own input, as without a sidechain
+            });
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("name", "DynamicPeak/" + juce::String(blockSize));
+            result->setProperty("blockSize", blockSize);
+            result->setProperty("staticNsPerSample", staticNs);
+            result->setProperty("dynamicNsPerSample", dynamicNs);
+            result->setProperty("ratio", dynamicNs / staticNs);
+            results.add(juce::var(result));
+
+            std::cout << juce::String(blockSize).paddedLeft(' ', 9) << juce::String(staticNs, 2).paddedLeft(' ', 23)
+                      << juce::String(dynamicNs, 2).paddedLeft(' ', 24) << juce::String(dynamicNs / staticNs, 2).paddedLeft(' ', 7) << std::endl;
+        }
+
+        return results;
+    }
+
+    template <typename DesignFunction>
+    static double timeDesign(int numDesigns, DesignFunction&& design)
+    {
+        for (int i = 0; i < 16; ++i)
+            design(i);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numDesigns; ++i)
+            design(i);
+        const auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numDesigns;
+    }
+
+    juce::var runCoefficientDesignBenchmarks(int numDesigns)
+    {
+        juce::Array<juce::var> results;
+        const auto sampleRate = 48000.0;
+        MonoChain chain;
+        prepareChain(chain, { sampleRate, 512, 1 });
+
+        auto addResult = [&results](const juce::String& name, double nsPerCall)
+        {
+            auto* result = new juce::DynamicObject();
+            result->setProperty("name", name);
+            result->setProperty("nsPerCall", nsPerCall);
+            results.add(juce::var(result));
+            std::cout << name << ": " << nsPerCall << " ns" << std::endl;
+        };
+
+        //the frequency moves on every call so nothing can be cached along the way
+        addResult("updatePeakFilter", timeDesign(numDesigns, [&](int i)
+        {
+            auto settings = makeSettings(Slope_12);
+            settings.bands[0].freq = 100.f + (float) (i % 1000) * 10.f;
+            updateCoefficients(chain.get<ChainPosition::Peak>().coefficients, makeBandFilter(settings.bands[0], sampleRate));
+        }));
+
+        for (auto slope : slopes)
+        {
+            addResult("updateCutFilter/" + juce::String(12 * (slope + 1)) + "dB", timeDesign(numDesigns, [&](int i)
+            {
+                auto settings = makeSettings(slope);
+                settings.lowCutFreq = 20.f + (float) (i % 1000);
+                updateCutFilter(chain.get<ChainPosition::LowCut>(), makeLowCutFilter(settings, sampleRate), settings.lowCutSlope);
+            }));
+        }
+
+        //a whole chain's worth of stages, what a change costs the biquad path on the design thread and the SVF on the audio thread.
+        //Something of each design is kept so the optimiser can't drop the work
+        volatile float sink = 0.f;
+        addResult("makeChainCoefficients/48dB", timeDesign(numDesigns, [&](int i)
+        {
+            auto settings = makeSettings(Slope_48);
+            settings.bands[0].freq = 100.f + (float) (i % 1000) * 10.f;
+            sink = sink + makeChainCoefficients(settings, sampleRate).lowCut[0][0];
+        }));
+
+        addResult("makeSvfCoefficients/48dB", timeDesign(numDesigns, [&](int i)
+        {
+            auto settings = makeSettings(Slope_48);
+            settings.bands[0].freq = 100.f + (float) (i % 1000) * 10.f;
+            sink = sink + makeSvfCoefficients(settings, sampleRate).stages[0].k;
+        }));
+
+        //the editor's curve rebuild for a 2000 px wide editor with every stage active, the version changes each call to defeat the cache
+        ResponseCurve curve;
+        auto curveCoefficients = makeChainCoefficients(makeSettings(Slope_48), sampleRate);
+        const juce::Rectangle<float> curveBounds(0.f, 0.f, 2000.f, 400.f);
+        addResult("ResponseCurve/2000px", timeDesign(numDesigns / 10, [&](int i)
+        {
+            curveCoefficients.version = (juce::uint32) i + 1;
+            curve.update(curveCoefficients, curveBounds, sampleRate);
+        }));
+
+        return results;
+    }
+}
@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    FilterChainBenchmarks.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Benchmark
+{
+    /** ns/sample of the reference MonoChain and of the processor's own chain for every Slope, block size (16..8192) and sample rate (44.1k..384k). */
+    juce::var runFilterChainBenchmarks(int samplesPerMeasurement);
+
+    /** ns/sample of each kernel for 0 to maxNumBands enabled bands, which should grow in a straight line with the band count. */
+    juce::var runBandScalingBenchmarks(int samplesPerMeasurement);
+
+    /** The biquad kernel self-test, then ns/sample of the bands with every instruction set variant this machine runs. */
+    juce::var runKernelIsaBenchmarks(int samplesPerMeasurement);
+
+    /** ns/sample of the static Peak band and of the dynamic mode's detector and bell while it is cutting, which should stay under 2x. */
+    juce::var runDynamicPeakBenchmarks(int samplesPerMeasurement);
+
+    /** ns per call of the peak and cut coefficient designs, the work the coefficient service does on every change,
+        of a whole chain designed as biquads and as state variable filters, and of the editor's response curve rebuild. */
+    juce::var runCoefficientDesignBenchmarks(int numDesigns);
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for the SimpleEQ benchmarks.
+
+    Usage: SimpleEQBenchmarks [--filterchain] [--bands] [--kernels] [--dynamic] [--coefficients] [--channels] [--session] [--idle]
+                              [--oversampling] [--startup]
+                              [--isa scalar|sse2|avx2|avx512] [--samples 1048576] [--designs 20000] [--instances 500]
+                              [--samplerate 48000] [--blocksize 512] [--blocks 2000]
+                              [--json results.json]
+
+    With no report selected every report runs. --json writes the results in
+    a machine readable form so releases can be compared against a baseline.
+    --isa forces that variant of the biquad kernels for every report that
+    goes through a processor, as SIMPLEEQ_KERNEL_ISA does for the plugin.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ChannelScaling.h"
+#include "FilterChainBenchmarks.h"
+#include "SessionLoad.h"
+#include "../../Source/BiquadKernels.h"
+#include "../../Source/RealtimeCounters.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; //the APVTS needs a message manager, no window is ever opened
+    const RealtimeCounters::ScopedAllocationCounting countAllocations; //our operator new counts what happens inside processBlock
+    juce::ArgumentList args (argc, argv);
+
+    const auto sampleRate = args.containsOption ("--samplerate") ? args.getValueForOption ("--samplerate").getDoubleValue() : 48000.0;
+    const auto blockSize = args.containsOption ("--blocksize") ? args.getValueForOption ("--blocksize").getIntValue() : 512;
+    const auto numBlocks = args.containsOption ("--blocks") ? args.getValueForOption ("--blocks").getIntValue() : 2000;
+    const auto samplesPerMeasurement = args.containsOption ("--samples") ? args.getValueForOption ("--samples").getIntValue() : 1 << 20;
+    const auto numDesigns = args.containsOption ("--designs") ? args.getValueForOption ("--designs").getIntValue() : 20000;
+    const auto numInstances = args.containsOption ("--instances") ? args.getValueForOption ("--instances").getIntValue() : 500;
+    const auto runAll = ! (args.containsOption ("--filterchain") || args.containsOption ("--bands") || args.containsOption ("--kernels")
+                           || args.containsOption ("--dynamic")
+                           || args.containsOption ("--coefficients")
+                           || args.containsOption ("--channels") || args.containsOption ("--session") || args.containsOption ("--idle")
+                           || args.containsOption ("--oversampling") || args.containsOption ("--startup"));
+
+    if (args.containsOption ("--isa"))
+    {
+        const auto name = args.getValueForOption ("--isa");
+        for (int isa = 0; isa < (int) KernelIsa::numIsas; ++isa)
+            if (name == BiquadKernels::getName ((KernelIsa) isa))
+                BiquadKernels::setOverride ((KernelIsa) isa);
+    }
+
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty ("juceVersion", juce::SystemStats::getJUCEVersion());
+    report->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty ("numCpus", juce::SystemStats::getNumCpus());
+    report->setProperty ("kernelIsa", BiquadKernels::getName (BiquadKernels::getSelected()));
+
+    if (runAll || args.containsOption ("--filterchain"))
+        report->setProperty ("filterChain", Benchmark::runFilterChainBenchmarks (samplesPerMeasurement));
+
+    if (runAll || args.containsOption ("--bands"))
+        report->setProperty ("bandScaling", Benchmark::runBandScalingBenchmarks (samplesPerMeasurement));
+
+    if (runAll || args.containsOption ("--kernels"))
+        report->setProperty ("kernelVariants", Benchmark::runKernelIsaBenchmarks (samplesPerMeasurement));
+
+    if (runAll || args.containsOption ("--dynamic"))
+        report->setProperty ("dynamicPeak", Benchmark::runDynamicPeakBenchmarks (samplesPerMeasurement));
+
+    if (runAll || args.containsOption ("--coefficients"))
+        report->setProperty ("coefficientDesign", Benchmark::runCoefficientDesignBenchmarks (numDesigns));
+
+    if (runAll || args.containsOption ("--channels"))
+        report->setProperty ("channelScaling", Benchmark::runChannelScalingReport (sampleRate, blockSize, numBlocks));
+
+    if (runAll || args.containsOption ("--session"))
+        report->setProperty ("sessionLoad", Benchmark::runSessionLoadBenchmark (numInstances, sampleRate, blockSize));
+
+    if (runAll || args.containsOption ("--idle"))
+        report->setProperty ("idleSession", Benchmark::runIdleSessionReport (numInstances, sampleRate, blockSize, juce::jmax (1, numBlocks / 10)));
+
+    if (runAll || args.containsOption ("--oversampling"))
+        report->setProperty ("oversampling", Benchmark::runOversamplingReport (sampleRate, blockSize, numBlocks));
+
+    if (runAll || args.containsOption ("--startup"))
+        report->setProperty ("startup", Benchmark::runStartupBenchmark (numInstances, sampleRate, blockSize));
+
+    if (args.containsOption ("--json"))
+    {
+        auto file = args.getFileForOption ("--json");
+        file.replaceWithText (juce::JSON::toString (juce::var (report.get())));
+    }
+
+    return 0;
+}
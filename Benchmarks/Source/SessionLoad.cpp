@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    SessionLoad.cpp
+
+  ==============================================================================
+*/
+
+#include "SessionLoad.h"
+#include "BenchmarkUtilities.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <psapi.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#elif JUCE_LINUX
+ #include <unistd.h>
+#endif
+
+namespace Benchmark
+{
+    static double millisecondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+
+    struct SessionTimes
+    {
+        double construct{ 0.0 }, restore{ 0.0 }, prepare{ 0.0 };
+    };
+
+    template <typename RestoreFunction>
+    static SessionTimes timeSession(int numInstances, double sampleRate, int blockSize, RestoreFunction&& restore)
+    {
+        juce::OwnedArray<SimpleEQAudioProcessor> instances; //all kept alive like in a real session
+        SessionTimes times;
+
+        auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numInstances; ++i)
+            instances.add(new SimpleEQAudioProcessor());
+        times.construct = millisecondsSince(start);
+
+        start = juce::Time::getHighResolutionTicks();
+        for (auto* instance : instances)
+            restore(*instance);
+        times.restore = millisecondsSince(start);
+
+        start = juce::Time::getHighResolutionTicks();
+        for (auto* instance : instances)
+            prepareProcessor(*instance, 2, sampleRate, blockSize);
+        times.prepare = millisecondsSince(start);
+
+        return times;
+    }
+
+    /** The process's resident set in bytes, 0 where there's no way to ask. */
+    static juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        //statm's second field is the resident set in pages
+        const auto fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), false);
+        return fields.size() > 1 ? fields[1].getLargeIntValue() * (juce::int64) sysconf(_SC_PAGESIZE) : 0;
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        return task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS ? (juce::int64) info.resident_size : 0;
+       #elif JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters;
+        return K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? (juce::int64) counters.WorkingSetSize : 0;
+       #else
+        return 0;
+       #endif
+    }
+
+    static juce::var makeResult(const juce::String& name, int numInstances, const SessionTimes& times, size_t stateSize)
+    {
+        const auto total = times.construct + times.restore + times.prepare;
+        std::cout << name << ": " << numInstances << " instances in " << total << " ms (construct " << times.construct
+                  << ", restore " << times.restore << ", prepare " << times.prepare << "), state " << stateSize << " bytes" << std::endl;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("instances", numInstances);
+        result->setProperty("constructMs", times.construct);
+        result->setProperty("restoreMs", times.restore);
+        result->setProperty("prepareMs", times.prepare);
+        result->setProperty("totalMs", total);
+        result->setProperty("stateBytes", (int) stateSize);
+        return juce::var(result);
+    }
+
+    juce::var runSessionLoadBenchmark(int numInstances, double sampleRate, int blockSize)
+    {
+        juce::Array<juce::var> results;
+
+        //one configured instance provides the saved state every instance of the session loads
+        SimpleEQAudioProcessor reference;
+        prepareProcessor(reference, 2, sampleRate, blockSize);
+        setParameter(reference, "LowCut Freq", 80.f);
+        setParameter(reference, "LowCut Slope", Slope_48);
+        setParameter(reference, "Peak Gain", 4.5f);
+        reference.prepareToPlay(sampleRate, blockSize); //designs the new values so the state carries them
+
+        juce::MemoryBlock binaryState;
+        reference.getStateInformation(binaryState);
+
+        juce::MemoryBlock xmlState;
+        if (auto xml = reference.apvts.copyState().createXml())
+            juce::AudioProcessor::copyXmlToBinary(*xml, xmlState);
+
+        results.add(makeResult("binary", numInstances, timeSession(numInstances, sampleRate, blockSize, [&](SimpleEQAudioProcessor& instance)
+        {
+            instance.setStateInformation(binaryState.getData(), (int) binaryState.getSize());
+        }), binaryState.getSize()));
+
+        results.add(makeResult("xml", numInstances, timeSession(numInstances, sampleRate, blockSize, [&](SimpleEQAudioProcessor& instance)
+        {
+            if (auto xml = juce::AudioProcessor::getXmlFromBinary(xmlState.getData(), (int) xmlState.getSize()))
+                instance.apvts.replaceState(juce::ValueTree::fromXml(*xml));
+        }), xmlState.getSize()));
+
+        //preset switches out of a memory mapped bank
+        juce::TemporaryFile bankFile(".seqbank");
+        std::vector<PresetBank::Preset> presets;
+        for (int i = 0; i < 64; ++i)
+        {
+            PresetBank::Preset preset;
+            preset.name = "Preset " + juce::String(i + 1);
+            preset.state.values = { { "LowCut Freq", 20.f + (float) i * 5.f }, { "Peak Gain", (float) (i % 24) - 12.f } };
+            presets.push_back(preset);
+        }
+
+        SimpleEQAudioProcessor scratch;
+        PresetBank::write(bankFile.getFile(), presets, scratch.apvts);
+
+        SimpleEQAudioProcessor instance;
+        prepareProcessor(instance, 2, sampleRate, blockSize);
+        if (instance.loadPresetBank(bankFile.getFile()))
+        {
+            constexpr int numSwitches = 10000;
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int i = 0; i < numSwitches; ++i)
+                instance.setCurrentProgram(i % instance.getNumPrograms());
+            const auto microseconds = millisecondsSince(start) * 1000.0 / numSwitches;
+
+            std::cout << "preset switch: " << microseconds << " us" << std::endl;
+            auto* result = new juce::DynamicObject();
+            result->setProperty("name", "presetSwitch");
+            result->setProperty("microsecondsPerSwitch", microseconds);
+            results.add(juce::var(result));
+        }
+
+        return results;
+    }
+
+    juce::var runStartupBenchmark(int numInstances, double sampleRate, int blockSize)
+    {
+        numInstances = juce::jmax(1, numInstances);
+        juce::OwnedArray<SimpleEQAudioProcessor> instances; //all kept alive like in a real session
+
+        auto start = juce::Time::getHighResolutionTicks();
+        instances.add(new SimpleEQAudioProcessor());
+        const auto firstMs = millisecondsSince(start);
+
+        const auto bytesBefore = getResidentBytes();
+        start = juce::Time::getHighResolutionTicks();
+        for (int i = 1; i < numInstances; ++i)
+            instances.add(new SimpleEQAudioProcessor());
+        const auto constructMs = millisecondsSince(start) / juce::jmax(1, numInstances - 1);
+        const auto constructBytes = (double) (getResidentBytes() - bytesBefore) / juce::jmax(1, numInstances - 1);
+
+        const auto bytesBeforePrepare = getResidentBytes();
+        start = juce::Time::getHighResolutionTicks();
+        for (auto* instance : instances)
+            prepareProcessor(*instance, 2, sampleRate, blockSize);
+        const auto prepareMs = millisecondsSince(start) / numInstances;
+        const auto prepareBytes = (double) (getResidentBytes() - bytesBeforePrepare) / numInstances;
+
+        start = juce::Time::getHighResolutionTicks();
+        instances.clear();
+        const auto destroyMs = millisecondsSince(start) / numInstances;
+
+        std::cout << numInstances << " instances: first " << firstMs << " ms, then " << constructMs * 1000.0 << " us and "
+                  << juce::roundToInt(constructBytes / 1024.0) << " KB each to construct, " << prepareMs * 1000.0 << " us and "
+                  << juce::roundToInt(prepareBytes / 1024.0) << " KB each to prepare, " << destroyMs * 1000.0 << " us each to destroy" << std::endl;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("instances", numInstances);
+        result->setProperty("firstInstanceMs", firstMs);
+        result->setProperty("constructMsPerInstance", constructMs);
+        result->setProperty("constructBytesPerInstance", constructBytes);
+        result->setProperty("prepareMsPerInstance", prepareMs);
+        result->setProperty("prepareBytesPerInstance", prepareBytes);
+        result->setProperty("destroyMsPerInstance", destroyMs);
+        return juce::var(result);
+    }
+}
@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    SessionLoad.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Benchmark
+{
+    /** Times what a host does per instance when it opens a session: construct, restore the state and prepare.
+        Runs numInstances with the binary state and again with the same values restored from XML for
+        comparison, then times preset switches from a memory mapped bank.
+    */
+    juce::var runSessionLoadBenchmark(int numInstances, double sampleRate, int blockSize);
+
+    /** What a host scan or a session load pays before any audio runs: constructs numInstances processors and
+        reports the time and the resident memory per instance, then the same for their first prepareToPlay.
+        The first instance is timed on its own, it builds what every later one shares.
+    */
+    juce::var runStartupBenchmark(int numInstances, double sampleRate, int blockSize);
+}
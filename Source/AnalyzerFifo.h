@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    AnalyzerFifo.h
+
+    Single producer / single consumer ring buffer that carries samples from
+    the audio thread to the spectrum analyzer. Both ends are wait-free: when
+    the analyzer falls behind, the audio thread drops what doesn't fit
+    instead of waiting for room.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class AnalyzerFifo
+{
+public:
+    static constexpr int capacity = 1 << 15; //fixed so nothing is ever reallocated under a running reader
+
+    AnalyzerFifo() = default;
+
+    /** The buffer is only allocated the first time an analyzer wants one, most instances in a session never open an editor.
+        Message thread, before anything is pushed and before the reader's thread starts, nothing guards the buffer against a running reader.
+    */
+    void allocate()
+    {
+        if (buffer.empty())
+            buffer.assign((size_t) capacity, 0.0f);
+    }
+
+    void push(const float* samples, int numSamples) noexcept //audio thread, only once allocate() has run
+    {
+        jassert(! buffer.empty());
+        const auto scope = fifo.write(numSamples);
+        copyIn(samples, scope.startIndex1, scope.blockSize1);
+        copyIn(samples + scope.blockSize1, scope.startIndex2, scope.blockSize2);
+
+        if (const auto dropped = numSamples - scope.blockSize1 - scope.blockSize2; dropped > 0)
+            droppedSamples.fetch_add(dropped, std::memory_order_relaxed);
+    }
+
+    int pull(float* destination, int maxSamples) noexcept //analyzer thread, started after allocate(), returns how many samples were read
+    {
+        const auto scope = fifo.read(maxSamples);
+        std::copy_n(buffer.data() + scope.startIndex1, scope.blockSize1, destination);
+        std::copy_n(buffer.data() + scope.startIndex2, scope.blockSize2, destination + scope.blockSize1);
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    juce::int64 getNumDroppedSamples() const noexcept { return droppedSamples.load(std::memory_order_relaxed); }
+
+private:
+    void copyIn(const float* samples, int start, int numSamples) noexcept
+    {
+        std::copy_n(samples, numSamples, buffer.data() + start);
+    }
+
+    juce::AbstractFifo fifo{ capacity };
+    std::vector<float> buffer;
+    std::atomic<juce::int64> droppedSamples{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (AnalyzerFifo)
+};
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    BandCascade.h
+
+    A run of biquads kept as structure of arrays: one array per coefficient
+    and one per state, indexed by stage. Only the stages that do something
+    are in the list, so the cost follows the number of enabled bands rather
+    than maxNumBands.
+
+    The skewed kernel runs stage k on sample i - k in iteration i. None of
+    the stages of one iteration depend on each other, so with coefficients
+    and states in separate arrays the loop over them is a plain element-wise
+    loop the compiler can vectorise. It lives in BiquadKernels, built once
+    per instruction set, and the list runs whichever variant it was given.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+#include "BiquadKernels.h"
+
+/** A compact list of active biquads. Every stage has an id (e.g. its band) so it keeps its state while others come and go. */
+template <typename SampleType, int MaxStages>
+class BiquadStageList
+{
+public:
+    static constexpr int maxNumStages = MaxStages;
+    static constexpr int laneCount = (int) (sizeof(SampleType) / sizeof(float)); //SIMD groups carry several channels per stage
+
+    void reset() noexcept
+    {
+        s1.fill({});
+        s2.fill({});
+    }
+
+    /** Call before adding the new list of stages. Audio thread safe. */
+    void beginUpdate() noexcept
+    {
+        idStates.fill({}); //ids that aren't active any more forget their state, so coming back starts from silence
+
+        for (int i = 0; i < numStages; ++i)
+            idStates[(size_t) ids[(size_t) i]] = { s1[(size_t) i], s2[(size_t) i] };
+
+        numStages = 0;
+    }
+
+    void add(int id, const BiquadCoefficients& stage) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(id, MaxStages) && numStages < MaxStages);
+        const auto i = (size_t) numStages++;
+        ids[i] = id;
+        coefficients.set((int) i, stage);
+        for (int lane = 0; lane < laneCount; ++lane) //the kernels see every lane as a stage of its own
+            laneCoefficients.set((int) i * laneCount + lane, stage);
+        s1[i] = idStates[(size_t) id].s1;
+        s2[i] = idStates[(size_t) id].s2;
+    }
+
+    int getNumStages() const noexcept { return numStages; }
+    const BiquadArrays<MaxStages>& getCoefficients() const noexcept { return coefficients; }
+    SampleType* getFirstStates() noexcept { return s1.data(); } //for kernels that keep the states in locals
+    SampleType* getSecondStates() noexcept { return s2.data(); }
+
+    /** The processSkewed variant, picked by the processor in prepareToPlay. */
+    void setKernel(BiquadKernels::Function newKernel) noexcept { kernel = newKernel; }
+
+    /** Every stage on each sample before moving on to the next sample, one pass over memory. */
+    void processFused(SampleType* samples, size_t numSamples) noexcept
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto x = samples[i];
+            for (int k = 0; k < numStages; ++k)
+                x = tick(k, x);
+            samples[i] = x;
+        }
+    }
+
+    /** Stage k works on sample i - k in iteration i, the loop over the stages has no dependencies. */
+    void processSkewed(SampleType* samples, size_t numSamples) noexcept
+    {
+        if (numStages == 0)
+            return;
+
+        //a SampleType is laneCount floats side by side, so the states already are stage major lanes
+        const LaneBiquads biquads{ laneCoefficients.b0.data(), laneCoefficients.b1.data(), laneCoefficients.b2.data(),
+                                   laneCoefficients.a1.data(), laneCoefficients.a2.data(),
+                                   reinterpret_cast<float*>(s1.data()), reinterpret_cast<float*>(s2.data()),
+                                   pipelineInput.data(), pipelineOutput.data(), numStages, laneCount };
+        kernel(biquads, reinterpret_cast<float*>(samples), numSamples);
+    }
+
+private:
+    SampleType tick(int k, SampleType x) noexcept //one transposed direct form II step of stage k
+    {
+        const auto i = (size_t) k;
+        const auto y = x * coefficients.b0[i] + s1[i];
+        s1[i] = x * coefficients.b1[i] - y * coefficients.a1[i] + s2[i];
+        s2[i] = x * coefficients.b2[i] - y * coefficients.a2[i];
+        return y;
+    }
+
+    BiquadArrays<MaxStages> coefficients;
+    BiquadArrays<MaxStages * laneCount> laneCoefficients; //each stage repeated for every lane, what the kernels read
+    std::array<SampleType, MaxStages> s1{}, s2{};
+    std::array<float, MaxStages * laneCount> pipelineInput{}, pipelineOutput{}; //the skewed kernel's scratch
+    BiquadKernels::Function kernel{ BiquadKernels::get(KernelIsa::sse2) }; //the build's baseline until told otherwise
+    std::array<int, MaxStages> ids{};
+    std::array<BiquadState<SampleType>, MaxStages> idStates; //only used while the list is rebuilt
+    int numStages{ 0 };
+};
+
+//==============================================================================
+/** The bands of a chain inside a juce::dsp::ProcessorChain, between the two CutCascades. Only the active bands run. */
+template <typename SampleType>
+class BandCascade
+{
+public:
+    void prepare(const juce::dsp::ProcessSpec&) noexcept { reset(); }
+
+    void reset() noexcept { stages.reset(); }
+
+    /** Audio thread safe. */
+    void setCoefficients(const BiquadArrays<maxNumBands>& bands) noexcept
+    {
+        stages.beginUpdate();
+        for (int band = 0; band < maxNumBands; ++band)
+            if (! bands.isIdentity(band))
+                stages.add(band, bands.get(band));
+    }
+
+    int getNumStages() const noexcept { return stages.getNumStages(); }
+    void setBiquadKernel(BiquadKernels::Function kernel) noexcept { stages.setKernel(kernel); }
+
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        auto& outputBlock = context.getOutputBlock();
+        jassert(outputBlock.getNumChannels() == 1); //one channel of SampleType, SIMD groups carry several channels in it
+
+        if (context.usesSeparateInputAndOutputBlocks())
+            outputBlock.copyFrom(context.getInputBlock());
+
+        if (! context.isBypassed)
+            stages.processSkewed(outputBlock.getChannelPointer(0), outputBlock.getNumSamples());
+    }
+
+private:
+    BiquadStageList<SampleType, maxNumBands> stages;
+};
+
+template <typename SampleType>
+void updateBands(BandCascade<SampleType>& cascade, const BiquadArrays<maxNumBands>& bands) noexcept
+{
+    cascade.setCoefficients(bands);
+}
+
+template <typename SampleType>
+void prepareAsBiquads(BandCascade<SampleType>&) noexcept {} //always biquads, nothing to resize
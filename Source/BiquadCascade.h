@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+
+    Cut filter cascades where the number of biquads is a compile time
+    constant. Every Slope gets its own instantiation, picked from a function
+    table when the slope changes, so the stage loop unrolls completely and
+    there are no bypassed stages to check or skip while processing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+using BiquadCoefficients = std::array<float, 5>; //b0, b1, b2, a1, a2 - the same layout juce::dsp::IIR::Coefficients uses for a biquad (a0 is normalised out)
+inline constexpr BiquadCoefficients identityBiquad{ 1.f, 0.f, 0.f, 0.f, 0.f }; //passes audio straight through
+
+/** Many biquads as structure of arrays, one array per coefficient, so a loop over the stages reads each one contiguously. */
+template <int NumStages>
+struct BiquadArrays
+{
+    std::array<float, NumStages> b0, b1, b2, a1, a2;
+
+    BiquadArrays() noexcept { for (int i = 0; i < NumStages; ++i) set(i, identityBiquad); }
+
+    void set(int stage, const BiquadCoefficients& c) noexcept
+    {
+        const auto i = (size_t) stage;
+        b0[i] = c[0]; b1[i] = c[1]; b2[i] = c[2]; a1[i] = c[3]; a2[i] = c[4];
+    }
+
+    BiquadCoefficients get(int stage) const noexcept
+    {
+        const auto i = (size_t) stage;
+        return { b0[i], b1[i], b2[i], a1[i], a2[i] };
+    }
+
+    bool isIdentity(int stage) const noexcept { return get(stage) == identityBiquad; }
+};
+
+template <typename SampleType>
+struct BiquadState
+{
+    SampleType s1{}, s2{}; //transposed direct form II, the same structure juce::dsp::IIR::Filter uses
+};
+
+/** Runs NumStages biquads over the samples, one pass per stage. */
+template <typename SampleType, int NumStages>
+void processBiquads(const BiquadCoefficients* coefficients, BiquadState<SampleType>* states, SampleType* samples, size_t numSamples) noexcept
+{
+    for (int stage = 0; stage < NumStages; ++stage) //constant trip count, the compiler unrolls this
+    {
+        const auto b0 = coefficients[stage][0], b1 = coefficients[stage][1], b2 = coefficients[stage][2];
+        const auto a1 = coefficients[stage][3], a2 = coefficients[stage][4];
+        auto s1 = states[stage].s1, s2 = states[stage].s2; //kept in registers for the whole block
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = samples[i];
+            const auto y = x * b0 + s1;
+            s1 = x * b1 - y * a1 + s2;
+            s2 = x * b2 - y * a2;
+            samples[i] = y;
+        }
+
+        states[stage].s1 = s1;
+        states[stage].s2 = s2;
+    }
+}
+
+//==============================================================================
+/** Drop-in replacement for a CutFilter inside a juce::dsp::ProcessorChain.
+    Holds all four stages but only ever runs the ones the slope needs.
+*/
+template <typename SampleType>
+class CutCascade
+{
+public:
+    static constexpr int maxNumStages = 4;
+
+    void prepare(const juce::dsp::ProcessSpec&) noexcept { reset(); }
+
+    void reset() noexcept { states.fill({}); }
+
+    /** Audio thread safe. Stages the new slope switches on start from silence rather than stale state. */
+    void setCoefficients(const std::array<BiquadCoefficients, maxNumStages>& newCoefficients, int slope) noexcept
+    {
+        coefficients = newCoefficients;
+        const auto newNumStages = juce::jlimit(0, maxNumStages, slope + 1); //none at all for Slope_Off
+
+        for (auto stage = numStages; stage < newNumStages; ++stage)
+            states[(size_t) stage] = {};
+
+        numStages = newNumStages;
+        processFunction = processFunctions[(size_t) numStages];
+    }
+
+    int getNumStages() const noexcept { return numStages; }
+
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        auto& outputBlock = context.getOutputBlock();
+        jassert(outputBlock.getNumChannels() == 1); //one channel of SampleType, SIMD groups carry several channels in it
+
+        if (context.usesSeparateInputAndOutputBlocks())
+            outputBlock.copyFrom(context.getInputBlock());
+
+        if (! context.isBypassed)
+            processFunction(coefficients.data(), states.data(), outputBlock.getChannelPointer(0), outputBlock.getNumSamples());
+    }
+
+private:
+    using ProcessFunction = void (*)(const BiquadCoefficients*, BiquadState<SampleType>*, SampleType*, size_t) noexcept;
+    static constexpr ProcessFunction processFunctions[maxNumStages + 1] = { &processBiquads<SampleType, 0>, //Slope_Off
+                                                                            &processBiquads<SampleType, 1>, //Slope_12
+                                                                            &processBiquads<SampleType, 2>, //Slope_24
+                                                                            &processBiquads<SampleType, 3>, //Slope_36
+                                                                            &processBiquads<SampleType, 4> }; //Slope_48
+
+    std::array<BiquadCoefficients, maxNumStages> coefficients{ identityBiquad, identityBiquad, identityBiquad, identityBiquad };
+    std::array<BiquadState<SampleType>, maxNumStages> states;
+    int numStages{ 1 };
+    ProcessFunction processFunction{ processFunctions[1] };
+};
+
+template <typename SampleType>
+void updateCutFilter(CutCascade<SampleType>& cascade, const std::array<BiquadCoefficients, 4>& cutCoefficients, int slope) noexcept
+{
+    cascade.setCoefficients(cutCoefficients, slope); //the slope picks the cascade, nothing gets bypassed
+}
+
+template <typename SampleType>
+void prepareAsBiquads(CutCascade<SampleType>&) noexcept {} //always biquads, nothing to resize
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    BiquadKernelLoop.h
+
+    The skewed biquad loop every BiquadKernels variant is compiled from, and
+    the lane layout it works on. Each variant is its own translation unit
+    built with its own instruction set flags, so this header stays clear of
+    JuceHeader: an inline function both a baseline and an AVX unit emit is
+    one symbol to the linker, and it may keep the AVX copy for everyone.
+    Everything here has internal linkage for the same reason.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+/** A run of biquads over interleaved lanes. Every array is numStages * numLanes long and stage major, lane l of stage k is at k * numLanes + l. */
+struct LaneBiquads
+{
+    const float *b0, *b1, *b2, *a1, *a2; //each stage's coefficients repeated for all of its lanes
+    float *s1, *s2;
+    float *input, *output; //scratch the kernel keeps the pipeline in
+    int numStages, numLanes;
+};
+
+/** Runs every stage over numSamples frames of numLanes interleaved floats, in place. Real-time safe. */
+using LaneBiquadsFunction = void (*)(const LaneBiquads& biquads, float* samples, size_t numSamples) noexcept;
+
+#if defined (_MSC_VER)
+ #define SIMPLEEQ_KERNEL_INLINE __forceinline
+ #define SIMPLEEQ_KERNEL_RESTRICT __restrict
+#else
+ #define SIMPLEEQ_KERNEL_INLINE inline __attribute__((always_inline))
+ #define SIMPLEEQ_KERNEL_RESTRICT __restrict__
+#endif
+
+namespace BiquadKernelLoop
+{
+namespace
+{
+    /** One iteration's worth of work: count independent stage-lanes. Kept in its own function so the pointers can be restrict. */
+    template <bool allowVectorisation>
+    SIMPLEEQ_KERNEL_INLINE void tickStages(const float* SIMPLEEQ_KERNEL_RESTRICT input, float* SIMPLEEQ_KERNEL_RESTRICT output,
+                                           const float* SIMPLEEQ_KERNEL_RESTRICT b0, const float* SIMPLEEQ_KERNEL_RESTRICT b1,
+                                           const float* SIMPLEEQ_KERNEL_RESTRICT b2, const float* SIMPLEEQ_KERNEL_RESTRICT a1,
+                                           const float* SIMPLEEQ_KERNEL_RESTRICT a2,
+                                           float* SIMPLEEQ_KERNEL_RESTRICT s1, float* SIMPLEEQ_KERNEL_RESTRICT s2, std::ptrdiff_t count) noexcept
+    {
+        if constexpr (allowVectorisation)
+        {
+            for (std::ptrdiff_t j = 0; j < count; ++j)
+            {
+                const auto x = input[j];
+                const auto y = x * b0[j] + s1[j];
+                s1[j] = x * b1[j] - y * a1[j] + s2[j];
+                s2[j] = x * b2[j] - y * a2[j];
+                output[j] = y;
+            }
+        }
+        else
+        {
+           #if defined (__clang__)
+            #pragma clang loop vectorize(disable) interleave(disable)
+           #elif defined (_MSC_VER)
+            #pragma loop(no_vector)
+           #endif
+            for (std::ptrdiff_t j = 0; j < count; ++j)
+            {
+                const auto x = input[j];
+                const auto y = x * b0[j] + s1[j];
+                s1[j] = x * b1[j] - y * a1[j] + s2[j];
+                s2[j] = x * b2[j] - y * a2[j];
+                output[j] = y;
+            }
+        }
+    }
+
+    //plain memcpy rather than std::copy, a library call has no inline body to pick up this unit's flags
+    SIMPLEEQ_KERNEL_INLINE void copyFloats(float* destination, const float* source, std::ptrdiff_t count) noexcept
+    {
+        if (count > 0)
+            std::memcpy(destination, source, (size_t) count * sizeof(float));
+    }
+
+    template <bool allowVectorisation>
+    SIMPLEEQ_KERNEL_INLINE void processSkewed(const LaneBiquads& biquads, float* samples, size_t numSamples) noexcept
+    {
+        const auto m = (std::ptrdiff_t) biquads.numStages;
+        const auto lanes = (std::ptrdiff_t) biquads.numLanes;
+        const auto n = (std::ptrdiff_t) numSamples;
+        if (m == 0)
+            return;
+
+        auto* input = biquads.input; //input[k * lanes + l] is what lane l of stage k works on this iteration
+        auto* output = biquads.output;
+
+        for (std::ptrdiff_t i = 0; i < n + m - 1; ++i)
+        {
+            //stage k is busy while 0 <= i - k < n, only the first and last few iterations cut the range short
+            const auto first = (i - n + 1 > 0 ? i - n + 1 : 0) * lanes;
+            const auto last = (i + 1 < m ? i + 1 : m) * lanes;
+
+            if (i < n)
+                copyFloats(input, samples + i * lanes, lanes);
+
+            tickStages<allowVectorisation>(input + first, output + first,
+                                           biquads.b0 + first, biquads.b1 + first, biquads.b2 + first, biquads.a1 + first, biquads.a2 + first,
+                                           biquads.s1 + first, biquads.s2 + first, last - first);
+
+            if (last == m * lanes) //sample i - m + 1 was read m - 1 iterations ago, writing it in place is safe
+                copyFloats(samples + (i - m + 1) * lanes, output + (m - 1) * lanes, lanes);
+
+            const auto shiftEnd = last < (m - 1) * lanes ? last : (m - 1) * lanes; //each stage's output is the next one's input
+            std::memmove(input + first + lanes, output + first, (size_t) (shiftEnd > first ? shiftEnd - first : 0) * sizeof(float));
+        }
+    }
+}
+}
@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    BiquadKernels.cpp
+
+  ==============================================================================
+*/
+
+#include "BiquadKernels.h"
+
+//the wider x86 variants are in files of their own, each built for its instruction set, see BiquadKernels.h
+#if JUCE_INTEL
+ #define SIMPLEEQ_ISA_VARIANTS 1
+LaneBiquadsFunction getBiquadKernelAvx2() noexcept;
+LaneBiquadsFunction getBiquadKernelAvx512() noexcept;
+#else
+ #define SIMPLEEQ_ISA_VARIANTS 0
+#endif
+
+#if JUCE_GCC
+ #define SIMPLEEQ_NO_VECTORISE __attribute__((optimize("no-tree-vectorize")))
+#else
+ #define SIMPLEEQ_NO_VECTORISE
+#endif
+
+SIMPLEEQ_NO_VECTORISE static void processScalar(const LaneBiquads& biquads, float* samples, size_t numSamples) noexcept
+{
+    BiquadKernelLoop::processSkewed<false>(biquads, samples, numSamples);
+}
+
+static void processBaseline(const LaneBiquads& biquads, float* samples, size_t numSamples) noexcept
+{
+    BiquadKernelLoop::processSkewed<true>(biquads, samples, numSamples);
+}
+
+//==============================================================================
+namespace BiquadKernels
+{
+    const char* getName(KernelIsa isa) noexcept
+    {
+        switch (isa)
+        {
+            case KernelIsa::scalar:  return "scalar";
+           #if JUCE_ARM
+            case KernelIsa::sse2:    return "neon";
+           #else
+            case KernelIsa::sse2:    return "sse2";
+           #endif
+            case KernelIsa::avx2:    return "avx2";
+            case KernelIsa::avx512:  return "avx512";
+            case KernelIsa::numIsas: break;
+        }
+
+        return "";
+    }
+
+    bool isSupported(KernelIsa isa) noexcept
+    {
+        switch (isa)
+        {
+            case KernelIsa::scalar:
+            case KernelIsa::sse2:    return true; //x86-64 always has SSE2, other targets run their own baseline
+           #if SIMPLEEQ_ISA_VARIANTS //the CPU first, the variant's getter is built for that instruction set too
+            case KernelIsa::avx2:    return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3() && getBiquadKernelAvx2() != nullptr;
+            case KernelIsa::avx512:  return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3()
+                                             && getBiquadKernelAvx512() != nullptr;
+           #else
+            case KernelIsa::avx2:
+            case KernelIsa::avx512:  return false;
+           #endif
+            case KernelIsa::numIsas: break;
+        }
+
+        return false;
+    }
+
+    Function get(KernelIsa isa) noexcept
+    {
+        if (! isSupported(isa))
+            return processScalar;
+
+        switch (isa)
+        {
+            case KernelIsa::sse2:    return processBaseline;
+           #if SIMPLEEQ_ISA_VARIANTS
+            case KernelIsa::avx2:    return getBiquadKernelAvx2();
+            case KernelIsa::avx512:  return getBiquadKernelAvx512();
+           #endif
+            default:                 return processScalar;
+        }
+    }
+
+    //==============================================================================
+    struct SelfTest
+    {
+        bool passed[(int) KernelIsa::numIsas]{};
+        double worstError[(int) KernelIsa::numIsas]{}; //relative to the reference's peak
+    };
+
+    //FMA rounds differently and 40 narrow low peaks in float spread that to around -75 dB of the peak,
+    //a kernel that is actually wrong (a stage skipped, lanes mixed up) is off by the order of the signal
+    static constexpr double selfTestTolerance = 1.0e-3;
+
+    /** A random peak like the plugin's bands: anywhere in the spectrum, +-12 dB, Q from 0.3 to 4 (the RBJ cookbook design). */
+    static void makeTestStage(juce::Random& random, float* coefficients)
+    {
+        const auto omega = juce::MathConstants<double>::pi * (0.001 + 0.9 * random.nextDouble());
+        const auto gain = std::pow(10.0, (random.nextDouble() * 24.0 - 12.0) / 40.0);
+        const auto alpha = std::sin(omega) / (2.0 * (0.3 + 3.7 * random.nextDouble()));
+        const auto a0 = 1.0 + alpha / gain;
+
+        coefficients[0] = (float) ((1.0 + alpha * gain) / a0);
+        coefficients[1] = (float) (-2.0 * std::cos(omega) / a0);
+        coefficients[2] = (float) ((1.0 - alpha * gain) / a0);
+        coefficients[3] = coefficients[1];
+        coefficients[4] = (float) ((1.0 - alpha / gain) / a0);
+    }
+
+    /** Runs one variant and the scalar reference on the same random cascade, over two blocks so the states are checked too. */
+    static double measureError(Function function, int numStages, int numLanes, int numSamples, juce::Random& random)
+    {
+        const auto size = (size_t) (numStages * numLanes);
+        std::vector<float> coefficients[5], states[2][2], scratch[2][2];
+        for (auto& c : coefficients)
+            c.resize(size);
+        for (auto& run : states)
+            for (auto& s : run)
+                s.assign(size, 0.0f);
+        for (auto& run : scratch)
+            for (auto& s : run)
+                s.assign(size, 0.0f);
+
+        for (int k = 0; k < numStages; ++k)
+        {
+            float stage[5];
+            makeTestStage(random, stage);
+            for (int l = 0; l < numLanes; ++l)
+                for (int c = 0; c < 5; ++c)
+                    coefficients[c][(size_t) (k * numLanes + l)] = stage[c];
+        }
+
+        std::vector<float> samples[2];
+        samples[0].resize((size_t) (numSamples * numLanes));
+        for (auto& sample : samples[0])
+            sample = random.nextFloat() * 2.0f - 1.0f;
+        samples[1] = samples[0];
+
+        const Function functions[2] = { processScalar, function };
+        double peak = 0.0, error = 0.0;
+
+        for (int block = 0; block < 2; ++block)
+        {
+            for (int run = 0; run < 2; ++run)
+            {
+                const LaneBiquads biquads{ coefficients[0].data(), coefficients[1].data(), coefficients[2].data(), coefficients[3].data(), coefficients[4].data(),
+                                           states[run][0].data(), states[run][1].data(), scratch[run][0].data(), scratch[run][1].data(), numStages, numLanes };
+                functions[run](biquads, samples[run].data(), (size_t) numSamples);
+            }
+
+            for (size_t i = 0; i < samples[0].size(); ++i)
+            {
+                peak = juce::jmax(peak, (double) std::abs(samples[0][i]));
+                error = juce::jmax(error, (double) std::abs(samples[0][i] - samples[1][i]));
+            }
+        }
+
+        return peak > 0.0 ? error / peak : error;
+    }
+
+    static SelfTest runSelfTest()
+    {
+        SelfTest result;
+        result.passed[(int) KernelIsa::scalar] = true;
+
+        for (int isa = 1; isa < (int) KernelIsa::numIsas; ++isa)
+        {
+            if (! isSupported((KernelIsa) isa))
+                continue;
+
+            juce::Random random(isa); //fixed seeds, the test is the same every run
+            double worst = 0.0;
+
+            //odd stage and lane counts catch remainder loops, blocks shorter than the cascade catch the pipeline fill and drain
+            for (auto numStages : { 1, 2, 3, 9, 17, 40 })
+                for (auto numLanes : { 1, 2, 4, 8, 16 })
+                    for (auto numSamples : { 1, 5, 64, 257 })
+                        worst = juce::jmax(worst, measureError(get((KernelIsa) isa), numStages, numLanes, numSamples, random));
+
+            result.worstError[isa] = worst;
+            result.passed[isa] = worst <= selfTestTolerance;
+            jassert(result.passed[isa]); //the compiler did something to this variant it shouldn't have
+        }
+
+        return result;
+    }
+
+    static const SelfTest& getSelfTest()
+    {
+        static const SelfTest result = runSelfTest(); //once per process, whichever instance prepares first pays for it
+        return result;
+    }
+
+    static std::atomic<int> overrideIsa{ -1 };
+
+    static int getEnvironmentOverride()
+    {
+        static const int isa = []
+        {
+            const auto requested = juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_KERNEL_ISA", {}).trim().toLowerCase();
+            for (int i = 0; i < (int) KernelIsa::numIsas; ++i)
+                if (requested == getName((KernelIsa) i))
+                    return i;
+            return -1;
+        }();
+
+        return isa;
+    }
+
+    KernelIsa getSelected()
+    {
+        const auto& selfTest = getSelfTest();
+        auto isUsable = [&selfTest](int isa) { return isSupported((KernelIsa) isa) && selfTest.passed[isa]; };
+
+        auto requested = overrideIsa.load();
+        if (requested < 0)
+            requested = getEnvironmentOverride();
+        if (requested >= 0 && isUsable(requested))
+            return (KernelIsa) requested;
+
+        for (int isa = (int) KernelIsa::numIsas - 1; isa > 0; --isa) //widest first
+            if (isUsable(isa))
+                return (KernelIsa) isa;
+
+        return KernelIsa::scalar;
+    }
+
+    void setOverride(std::optional<KernelIsa> isa) noexcept
+    {
+        overrideIsa = isa.has_value() ? (int) *isa : -1;
+    }
+
+    juce::String getSelfTestReport()
+    {
+        const auto& selfTest = getSelfTest();
+        juce::String report;
+
+        for (int isa = 0; isa < (int) KernelIsa::numIsas; ++isa)
+        {
+            report << juce::String(getName((KernelIsa) isa)).paddedRight(' ', 8);
+            if (! isSupported((KernelIsa) isa))
+                report << "not available on this machine";
+            else if (isa == (int) KernelIsa::scalar)
+                report << "reference";
+            else
+                report << (selfTest.passed[isa] ? "passed" : "FAILED") << ", worst error " << juce::String(selfTest.worstError[isa], 9);
+            report << juce::newLine;
+        }
+
+        return report;
+    }
+}
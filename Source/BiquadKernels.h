@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    BiquadKernels.h
+
+    The skewed biquad kernel (see BandCascade.h) compiled once per instruction
+    set, so one binary runs each machine's widest vectors. Every variant is
+    the same source: stage k runs on sample i - k in iteration i, and with
+    the lanes of one stage next to each other the work of an iteration is a
+    single element-wise loop over stages * lanes floats, which the compiler
+    vectorises 4, 8 or 16 wide depending on the variant's target.
+
+    The loop itself is in BiquadKernelLoop.h. The AVX2 and AVX-512 variants
+    live in translation units of their own, BiquadKernelsAvx2.cpp and
+    BiquadKernelsAvx512.cpp, so MSVC can build them with per-file /arch
+    flags. GCC and Clang build them with target attributes instead.
+
+    The variant is picked once per prepareToPlay: the widest one the CPU has
+    that passed the self-test against the scalar reference, unless
+    setOverride() or the SIMPLEEQ_KERNEL_ISA environment variable
+    (scalar, sse2, avx2, avx512) asks for another.
+
+    Only the skewed kernel is dispatched: BandCascade, which runs the bands,
+    and FusedChain's chains too long to unroll. The cut cascades and
+    FusedChain's unrolled kernels stay at the build's baseline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+#include "BiquadKernelLoop.h"
+
+enum class KernelIsa
+{
+    scalar, //no vectorisation, the reference the others are tested against
+    sse2,   //the build's own baseline, NEON on ARM
+    avx2,   //with FMA
+    avx512,
+    numIsas
+};
+
+namespace BiquadKernels
+{
+    /** Runs every stage over numSamples frames of numLanes interleaved floats, in place. Real-time safe. */
+    using Function = LaneBiquadsFunction;
+
+    const char* getName(KernelIsa isa) noexcept;
+    bool isSupported(KernelIsa isa) noexcept; //built into this binary and available on this CPU
+    Function get(KernelIsa isa) noexcept; //the scalar one for anything unsupported
+
+    /** The variant to use now. The first call runs the self-test, later calls just read the result. */
+    KernelIsa getSelected();
+
+    /** Forces a variant for testing, std::nullopt goes back to picking automatically. Unsupported or failing variants are ignored. */
+    void setOverride(std::optional<KernelIsa> isa) noexcept;
+
+    /** One line per variant: supported or not, and the self-test's worst error against the scalar reference. */
+    juce::String getSelfTestReport();
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    BiquadKernelsAvx2.cpp
+
+    The AVX2 with FMA variant of the skewed biquad kernel, in a file of its own so
+    each compiler can build it for that instruction set without the rest of
+    the plugin following. MSVC has no per-function targets: the .jucer gives
+    this file the "avx2" compiler flag scheme, /arch:AVX2. GCC and Clang take
+    a target attribute on the one function below and need no flags. Either
+    way BiquadKernels only asks for it once the CPU has said it can run it.
+
+  ==============================================================================
+*/
+
+#include "BiquadKernelLoop.h"
+
+#if defined (_MSC_VER) && ! defined (__clang__)
+ #if defined (__AVX2__) //the scheme's flags made it into the build
+  #define SIMPLEEQ_KERNEL_VARIANT 1
+  #define SIMPLEEQ_KERNEL_TARGET
+ #endif
+#elif defined (__x86_64__) || defined (__i386__)
+ #define SIMPLEEQ_KERNEL_VARIANT 1
+ #define SIMPLEEQ_KERNEL_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+#ifdef SIMPLEEQ_KERNEL_VARIANT
+SIMPLEEQ_KERNEL_TARGET static void processAvx2(const LaneBiquads& biquads, float* samples, size_t numSamples) noexcept
+{
+    BiquadKernelLoop::processSkewed<true>(biquads, samples, numSamples); //always inlined, so built for this function's target
+}
+#endif
+
+LaneBiquadsFunction getBiquadKernelAvx2() noexcept //nullptr when this build has no such variant
+{
+   #ifdef SIMPLEEQ_KERNEL_VARIANT
+    return processAvx2;
+   #else
+    return nullptr;
+   #endif
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    ChainOversampler.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainOversampler.h"
+
+void ChainOversampler::prepare(int numChannels, int maximumBlockSize)
+{
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        allocated[i] = false;
+        stages[i] = Stage();
+    }
+
+    preparedChannels = numChannels;
+    preparedBlockSize = maximumBlockSize;
+}
+
+void ChainOversampler::allocate(int factor)
+{
+    using Oversampling = juce::dsp::Oversampling<float>;
+
+    if (isAllocated(factor) || preparedBlockSize <= 0)
+        return;
+
+    //one half-band stage per doubling, at the highest quality, with a fractional delay added so the latency is whole samples
+    const auto index = (size_t) getStageIndex(factor);
+    auto& stage = stages[index];
+    stage.oversampling = std::make_unique<Oversampling>((size_t) preparedChannels, index + 1, Oversampling::filterHalfBandPolyphaseIIR, true, true);
+    stage.oversampling->initProcessing((size_t) preparedBlockSize);
+    stage.latency = juce::roundToInt(stage.oversampling->getLatencyInSamples());
+    stage.delayLines.setSize(preparedChannels, juce::jmax(1, stage.latency));
+    stage.delayLines.clear();
+    stage.delayPosition = 0;
+    stage.spare.setSize(preparedChannels, preparedBlockSize);
+
+    allocated[index].store(true, std::memory_order_release);
+}
+
+void ChainOversampler::reset() noexcept
+{
+    for (int factor = 2; factor <= maxOversamplingFactor; factor *= 2)
+    {
+        if (! isAllocated(factor))
+            continue;
+
+        resetResampling(factor);
+        resetDelay(factor);
+    }
+}
+
+void ChainOversampler::resetResampling(int factor) noexcept
+{
+    jassert(factor > 1 && isAllocated(factor));
+    stages[(size_t) getStageIndex(factor)].oversampling->reset();
+}
+
+void ChainOversampler::resetDelay(int factor) noexcept
+{
+    jassert(factor > 1 && isAllocated(factor));
+    auto& stage = stages[(size_t) getStageIndex(factor)];
+    stage.delayLines.clear();
+    stage.delayPosition = 0;
+}
+
+int ChainOversampler::getLatencySamples(int factor) const noexcept
+{
+    return factor > 1 && isAllocated(factor) ? stages[(size_t) getStageIndex(factor)].latency : 0;
+}
+
+juce::dsp::AudioBlock<float> ChainOversampler::getSpareBlock(int factor, size_t numChannels, size_t numSamples) noexcept
+{
+    auto& spare = stages[(size_t) getStageIndex(factor)].spare;
+    jassert((int) numChannels <= spare.getNumChannels() && (int) numSamples <= spare.getNumSamples());
+    return juce::dsp::AudioBlock<float>(spare).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+}
+
+void ChainOversampler::delay(const juce::dsp::AudioBlock<float>& block, int factor) noexcept
+{
+    auto& stage = stages[(size_t) getStageIndex(factor)];
+    const auto delayLength = stage.latency;
+    if (delayLength <= 0)
+        return;
+
+    const auto numChannels = juce::jmin((int) block.getNumChannels(), stage.delayLines.getNumChannels());
+    const auto numSamples = (int) block.getNumSamples();
+    auto position = stage.delayPosition;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = block.getChannelPointer((size_t) channel);
+        auto* ring = stage.delayLines.getWritePointer(channel);
+        position = stage.delayPosition;
+
+        for (int i = 0; i < numSamples; ++i) //what went in delayLength samples ago comes out, this sample takes its place
+        {
+            const auto x = samples[i];
+            samples[i] = ring[position];
+            ring[position] = x;
+            if (++position == delayLength)
+                position = 0;
+        }
+    }
+
+    stage.delayPosition = numChannels > 0 ? position : (stage.delayPosition + numSamples) % delayLength;
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    ChainOversampler.h
+
+    Runs the IIR chain at 2, 4 or 8 times the host's rate, so bands near
+    Nyquist keep the shape they would have in the analog prototype instead
+    of the bilinear transform's squeezed one. Only the chain is resampled,
+    with JUCE's cascaded polyphase half-band IIRs, which is a lot cheaper
+    than running the whole session at the higher rate. Every channel goes
+    up together, so the channel groups keep their SIMD lanes full at the
+    high rate just as at the base one.
+
+    The resampling filters add latency. While a factor is asked for, the
+    chain running at the base rate is delayed by that much too, so the
+    latency the host compensates for stays put as bands move in and out of
+    the cramped region, and the two lined up outputs can be crossfaded.
+
+    Nothing for a factor is allocated until it's first asked for, on the
+    message thread, so an instance with Oversampling Off holds none of it.
+    The audio thread only touches a factor once isAllocated says so, and
+    runs the chain at the base rate until then. A host that never runs a
+    message loop only ever gets what prepareToPlay allocated.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+class ChainOversampler
+{
+public:
+    void prepare(int numChannels, int maximumBlockSize); //frees every factor and keeps the sizes for allocate(), call from prepareToPlay only
+    void allocate(int factor); //message thread, builds the factor's filters and buffers unless it has them already
+    bool isAllocated(int factor) const noexcept { return factor <= 1 || allocated[(size_t) getStageIndex(factor)].load(std::memory_order_acquire); }
+    void reset() noexcept; //clears every allocated factor's filters and delay
+    void resetResampling(int factor) noexcept; //before the oversampled chain starts again at that factor
+    void resetDelay(int factor) noexcept; //before the base rate chain starts again with that factor's delay
+
+    /** Samples of latency at the base rate while factor is asked for, 0 for 1 or one that isn't allocated yet. Integer, so the host can compensate exactly. */
+    int getLatencySamples(int factor) const noexcept;
+
+    /** Resamples the block up by factor, runs processChain on it and brings the result back down in place.
+        A block longer than prepare() was told goes through in pieces that fit the resampling's buffers.
+    */
+    template <typename ProcessChain>
+    void process(const juce::dsp::AudioBlock<float>& block, int factor, ProcessChain&& processChain) noexcept
+    {
+        auto& oversampling = *stages[(size_t) getStageIndex(factor)].oversampling;
+        const auto numSamples = block.getNumSamples();
+
+        for (size_t start = 0; start < numSamples; start += (size_t) preparedBlockSize)
+        {
+            auto piece = block.getSubBlock(start, juce::jmin((size_t) preparedBlockSize, numSamples - start));
+            auto upsampled = oversampling.processSamplesUp(piece).getSubsetChannelBlock(0, block.getNumChannels());
+            processChain(upsampled);
+            oversampling.processSamplesDown(piece);
+        }
+    }
+
+    /** Holds the base rate chain's output back by factor's latency, so it lines up with what process() gives at that factor. */
+    void delay(const juce::dsp::AudioBlock<float>& block, int factor) noexcept;
+
+    /** Room for the second chain while both run. Only as big as prepare() was told, the processor cuts longer host blocks down to that. */
+    juce::dsp::AudioBlock<float> getSpareBlock(int factor, size_t numChannels, size_t numSamples) noexcept;
+
+private:
+    static int getStageIndex(int factor) noexcept { return factor >= 8 ? 2 : factor >= 4 ? 1 : 0; } //2x, 4x, 8x
+
+    struct Stage
+    {
+        std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;
+        int latency{ 0 };
+        juce::AudioBuffer<float> delayLines; //one ring per channel, latency samples long
+        int delayPosition{ 0 };
+        juce::AudioBuffer<float> spare;
+    };
+    std::array<Stage, 3> stages;
+    std::array<std::atomic<bool>, 3> allocated{}; //set once a stage is complete, the audio and design threads read nothing of it before
+    int preparedChannels{ 0 }, preparedBlockSize{ 0 }; //for allocate()
+};
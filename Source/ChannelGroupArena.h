@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    ChannelGroupArena.h
+
+    Every channel group of the processor, coefficients, states and
+    interleave buffer, in one block of memory. Each group gets a slot that
+    starts on a cache line: the group itself, then its buffer. A group's
+    whole working set is one contiguous run, the next group's is right
+    after it, and two workers on neighbouring groups never write to the
+    same cache line.
+
+    The block is allocated in prepare(), from prepareToPlay, and kept: a
+    later prepare() that fits rebuilds the groups in place, so after the
+    first one nothing allocates, not even a sample rate or block size
+    change that needs no more room.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <typename GroupType>
+class ChannelGroupArena
+{
+public:
+    static constexpr size_t cacheLineSize = 64;
+
+    ChannelGroupArena() = default;
+    ~ChannelGroupArena() { clear(); }
+
+    /** Builds numGroups prepared groups. Message thread only, the audio thread mustn't be processing. */
+    void prepare(int numGroups, const juce::dsp::ProcessSpec& spec)
+    {
+        static_assert(alignof(GroupType) <= cacheLineSize && GroupType::bufferAlignment <= cacheLineSize);
+        clear();
+
+        const auto bufferOffset = roundUp(sizeof(GroupType), GroupType::bufferAlignment);
+        const auto newSlotSize = roundUp(bufferOffset + GroupType::getBufferSize(spec.maximumBlockSize), cacheLineSize);
+        const auto bytesNeeded = newSlotSize * (size_t) numGroups;
+
+        if (bytesNeeded > capacity)
+        {
+            storage.allocate(bytesNeeded + cacheLineSize, false); //the spare line is room to align the start
+            capacity = bytesNeeded;
+        }
+
+        const auto address = reinterpret_cast<juce::pointer_sized_uint>(storage.get());
+        base = storage.get() + (cacheLineSize - address % cacheLineSize) % cacheLineSize;
+        slotSize = newSlotSize;
+
+        for (int i = 0; i < numGroups; ++i)
+        {
+            auto* slot = base + (size_t) i * slotSize;
+            auto* group = new (slot) GroupType(); //placement new, the arena owns the memory
+            group->prepare(spec, slot + bufferOffset);
+            ++numConstructed;
+        }
+    }
+
+    /** Destroys the groups, keeps the memory for the next prepare(). */
+    void clear() noexcept
+    {
+        for (int i = numConstructed; --i >= 0;)
+            getUnchecked(i).~GroupType();
+        numConstructed = 0;
+    }
+
+    int size() const noexcept { return numConstructed; }
+    GroupType& getUnchecked(int index) noexcept { return *reinterpret_cast<GroupType*>(base + (size_t) index * slotSize); }
+
+    template <typename Function>
+    void forEach(Function&& function) noexcept
+    {
+        for (int i = 0; i < numConstructed; ++i)
+            function(getUnchecked(i));
+    }
+
+private:
+    static constexpr size_t roundUp(size_t bytes, size_t alignment) noexcept { return (bytes + alignment - 1) / alignment * alignment; }
+
+    juce::HeapBlock<char> storage;
+    char* base{ nullptr }; //the first cache line boundary in storage
+    size_t capacity{ 0 }, slotSize{ 0 };
+    int numConstructed{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (ChannelGroupArena)
+};
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    ChannelGroupChain.h
+
+    Runs the LowCut / Bands / HighCut cascade for a group of channels at once.
+    With SampleType = juce::dsp::SIMDRegister<float> the channels' biquad
+    states sit side by side in one register, so each stage updates every
+    channel of the group with one instruction. With SampleType = float it is
+    a plain single channel MonoChain.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+#include "BandCascade.h"
+#include "FusedChain.h"
+
+template <typename SampleType>
+class ChannelGroupChain
+{
+public:
+    using GroupCutFilter = CutCascade<SampleType>; //one unrolled cascade per slope instead of four bypassable filters
+    using GroupBands = BandCascade<SampleType>; //only the enabled bands, same float coefficients for every lane
+    using GroupChain = juce::dsp::ProcessorChain<GroupCutFilter, GroupBands, GroupCutFilter>; //same ChainPosition order as MonoChain
+
+    static constexpr size_t laneCount = sizeof(SampleType) / sizeof(float); //how many channels one group can carry
+
+    static constexpr size_t bufferAlignment = alignof(SampleType) > 16 ? alignof(SampleType) : 16;
+
+    /** Bytes of interleave buffer a group needs for blocks of up to maximumBlockSize, none for a single channel. */
+    static constexpr size_t getBufferSize(size_t maximumBlockSize) noexcept { return laneCount > 1 ? maximumBlockSize * sizeof(SampleType) : 0; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec) //allocates the interleave buffer, call from prepareToPlay only
+    {
+        ownBuffer.allocate(getBufferSize(spec.maximumBlockSize) + bufferAlignment, false);
+        const auto address = reinterpret_cast<juce::pointer_sized_uint>(ownBuffer.get());
+        prepare(spec, ownBuffer.get() + (bufferAlignment - address % bufferAlignment) % bufferAlignment);
+    }
+
+    /** Runs out of a buffer of getBufferSize() bytes someone else owns, aligned to bufferAlignment. Doesn't allocate. */
+    void prepare(const juce::dsp::ProcessSpec& spec, void* buffer) noexcept
+    {
+        jassert(reinterpret_cast<juce::pointer_sized_uint>(buffer) % bufferAlignment == 0);
+        auto groupSpec = spec;
+        groupSpec.numChannels = 1; //a single channel of SampleType carries the whole group
+        prepareChain(chain, groupSpec);
+        fused.reset();
+
+        if constexpr (laneCount > 1)
+        {
+            interleaved = static_cast<SampleType*>(buffer);
+            maximumBlockSize = spec.maximumBlockSize;
+            std::fill(interleaved, interleaved + maximumBlockSize, SampleType()); //unused lanes stay at zero so they never produce denormals
+        }
+    }
+
+    void apply(const ChainCoefficients& coefficients) noexcept //both kernels are kept up to date so switching is instant
+    {
+        applyCoefficients(chain, coefficients);
+        fused.setCoefficients(coefficients);
+        isIdentity = coefficients.getNumActiveStages() == 0;
+    }
+
+    void reset() noexcept //clears both kernels' states
+    {
+        chain.reset();
+        fused.reset();
+    }
+
+    void setKernel(ChainKernel newKernel) noexcept //audio thread only
+    {
+        if (newKernel == kernel)
+            return;
+
+        //the kernels keep separate states, start the new one from silence rather than from wherever it was left
+        if (newKernel == ChainKernel::processorChain)
+            chain.reset();
+        else if (kernel == ChainKernel::processorChain)
+            fused.reset();
+
+        kernel = newKernel;
+    }
+
+    void setBiquadKernel(BiquadKernels::Function kernel) noexcept //the instruction set variant of the skewed kernel, from prepareToPlay
+    {
+        chain.template get<ChainPosition::Bands>().setBiquadKernel(kernel);
+        fused.setBiquadKernel(kernel);
+    }
+
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept //takes up to laneCount channels
+    {
+        jassert(block.getNumChannels() <= laneCount);
+
+        if (isIdentity) //nothing in the chain, not even worth interleaving
+            return;
+
+        if constexpr (laneCount == 1)
+        {
+            auto channelBlock = block;
+            processInPlace(channelBlock);
+        }
+        else
+        {
+            const auto numChannels = block.getNumChannels();
+            const auto numSamples = block.getNumSamples();
+            jassert(numSamples <= maximumBlockSize); //the processor cuts host blocks down to the prepared size, the buffer is no bigger
+
+            auto* lanes = reinterpret_cast<float*>(interleaved);
+
+            for (size_t channel = 0; channel < numChannels; ++channel) //interleave, one lane per channel
+            {
+                auto* source = block.getChannelPointer(channel);
+                for (size_t i = 0; i < numSamples; ++i)
+                    lanes[i * laneCount + channel] = source[i];
+            }
+
+            juce::dsp::AudioBlock<SampleType> groupBlock(&interleaved, 1, numSamples);
+            processInPlace(groupBlock);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* destination = block.getChannelPointer(channel);
+                for (size_t i = 0; i < numSamples; ++i)
+                    destination[i] = lanes[i * laneCount + channel];
+            }
+        }
+    }
+
+private:
+    void processInPlace(juce::dsp::AudioBlock<SampleType>& groupBlock) noexcept
+    {
+        if (kernel == ChainKernel::processorChain)
+        {
+            juce::dsp::ProcessContextReplacing<SampleType> context(groupBlock);
+            chain.process(context);
+        }
+        else
+        {
+            fused.process(groupBlock.getChannelPointer(0), groupBlock.getNumSamples(), kernel == ChainKernel::fusedPipelined);
+        }
+    }
+
+    GroupChain chain;
+    FusedChain<SampleType> fused;
+    ChainKernel kernel{ ChainKernel::processorChain };
+    bool isIdentity{ false };
+    SampleType* interleaved{ nullptr }; //one SampleType per sample, lane n = channel n of the group
+    size_t maximumBlockSize{ 0 };
+    juce::HeapBlock<char> ownBuffer; //used when no buffer is handed in, the processor's groups get theirs from a ChannelGroupArena
+
+    JUCE_LEAK_DETECTOR (ChannelGroupChain)
+};
+
+#if JUCE_USE_SIMD
+using SIMDChannelGroup = ChannelGroupChain<juce::dsp::SIMDRegister<float>>;
+#else
+using SIMDChannelGroup = ChannelGroupChain<float>; //no SIMD on this target, every group is a single channel
+#endif
+using ScalarChannelGroup = ChannelGroupChain<float>;
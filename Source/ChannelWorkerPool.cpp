@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+
+class ChannelWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(ChannelWorkerPool& p, int i) : juce::Thread("SimpleEQ Channel Worker " + juce::String(i)), pool(p), index(i) {}
+    ~Worker() override { stopThread(1000); }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (pool.workOnCurrentJob())
+                continue;
+
+            if (index < pool.activeWorkers.load(std::memory_order_relaxed)
+                && juce::Time::getHighResolutionTicks() < pool.spinUntil.load(std::memory_order_relaxed))
+                juce::Thread::yield(); //stay hot until the next block is due
+            else
+                wait(1); //playback stopped or nobody needs this many helpers, back off so idle workers cost nothing
+        }
+    }
+
+private:
+    ChannelWorkerPool& pool;
+    const int index;
+};
+
+//==============================================================================
+static constexpr juce::uint64 taskIndexMask = 0xffff;
+
+ChannelWorkerPool::ChannelWorkerPool()
+{
+    const auto numWorkers = juce::SystemStats::getNumCpus() - 1;
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+        worker->startRealtimeThread(juce::Thread::RealtimeOptions{}); //same scheduling class as the audio thread
+    }
+}
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    workers.clear(); //each Worker's destructor stops its thread
+}
+
+void ChannelWorkerPool::run(Task task, void* context, int numTasks, double spinSeconds) noexcept
+{
+    jassert(numTasks >= 0 && (juce::uint64) numTasks <= taskIndexMask);
+
+    if (busy.exchange(true, std::memory_order_acquire)) //another instance's job has the workers, ours goes on this thread alone
+    {
+        for (int i = 0; i < numTasks; ++i)
+            task(context, i);
+        return;
+    }
+
+    const auto spinTicks = juce::Time::secondsToHighResolutionTicks(spinSeconds);
+    activeWorkers.store(numTasks - 1, std::memory_order_relaxed); //the caller takes a share itself
+    spinUntil.store(juce::Time::getHighResolutionTicks() + spinTicks, std::memory_order_relaxed);
+
+    //the previous job has fully finished, so nobody can be reading these now
+    currentTask.store(task, std::memory_order_relaxed);
+    currentContext.store(context, std::memory_order_relaxed);
+    tasksFinished.store(0, std::memory_order_relaxed);
+
+    ++generation;
+    claimState.store(((juce::uint64) generation << 32) | ((juce::uint64) numTasks << 16), std::memory_order_release);
+
+    workOnCurrentJob();
+
+    while (tasksFinished.load(std::memory_order_acquire) < numTasks) //only waits on tasks a worker is already running
+        juce::Thread::yield();
+
+    spinUntil.store(juce::Time::getHighResolutionTicks() + spinTicks, std::memory_order_relaxed);
+    busy.store(false, std::memory_order_release);
+}
+
+bool ChannelWorkerPool::workOnCurrentJob() noexcept
+{
+    bool didWork = false;
+    auto state = claimState.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto numTasks = (state >> 16) & taskIndexMask;
+        const auto taskIndex = state & taskIndexMask;
+
+        if (taskIndex >= numTasks)
+            return didWork;
+
+        if (! claimState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue; //someone else got there first or a new job arrived, look again
+
+        //the claim succeeded so this job can't finish (and be replaced) before we do
+        auto* task = currentTask.load(std::memory_order_relaxed);
+        task(currentContext.load(std::memory_order_relaxed), (int) taskIndex);
+        tasksFinished.fetch_add(1, std::memory_order_release);
+        didWork = true;
+        state = claimState.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+
+    A small pool of worker threads that the audio thread can fan a job out to
+    without taking a lock or waiting on a sleeping thread. The calling thread
+    always works on the job itself, idle workers just help claim tasks.
+
+    There is one pool per process, shared through a juce::SharedResourcePointer
+    like the coefficient design thread, so a session full of instances has at
+    most one real-time worker per spare core rather than one per core each.
+    One job runs at a time. An instance that finds the workers busy with
+    another instance's job does its own tasks, the host is already running
+    the two in parallel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ChannelWorkerPool
+{
+public:
+    using Task = void (*)(void* context, int taskIndex);
+
+    ChannelWorkerPool(); //starts one worker per core but the caller's, from the prepareToPlay of the first instance that wants it
+    ~ChannelWorkerPool();
+
+    /** Runs task(context, 0 .. numTasks - 1) spread over the calling thread and the workers.
+        Returns once every task has finished. Real-time safe.
+        The workers that helped keep spinning for spinSeconds afterwards, about a block period keeps them hot for the next block
+        without leaving them burning a core once the host stops calling.
+    */
+    void run(Task task, void* context, int numTasks, double spinSeconds) noexcept;
+
+    int getNumWorkers() const noexcept { return workers.size(); }
+
+private:
+    class Worker;
+
+    bool workOnCurrentJob() noexcept; //returns true if it ran at least one task
+
+    //generation (upper 32 bits) | number of tasks (16 bits) | next task to claim (16 bits)
+    //packing them lets a claim fail cleanly if a new job was published in the meantime
+    std::atomic<juce::uint64> claimState{ 0 };
+    std::atomic<Task> currentTask{ nullptr };
+    std::atomic<void*> currentContext{ nullptr };
+    std::atomic<int> tasksFinished{ 0 };
+    juce::uint32 generation{ 0 };
+
+    std::atomic<bool> busy{ false }; //a job is running, the fields above belong to whoever set it
+    std::atomic<int> activeWorkers{ 0 }; //workers with a lower index than this help, the rest would only find nothing to claim
+    std::atomic<juce::int64> spinUntil{ 0 }; //high resolution ticks, the helpers go back to sleeping after this
+
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelWorkerPool)
+};
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    CoefficientService.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientService.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+CoefficientDesignThread::CoefficientDesignThread() : juce::Thread("SimpleEQ Coefficient Designer")
+{
+    startThread();
+}
+
+CoefficientDesignThread::~CoefficientDesignThread()
+{
+    stopThread(1000);
+}
+
+void CoefficientDesignThread::add(CoefficientService* service)
+{
+    const juce::ScopedLock sl(lock);
+    services.addIfNotAlreadyThere(service);
+}
+
+void CoefficientDesignThread::remove(CoefficientService* service)
+{
+    const juce::ScopedLock sl(lock); //blocks until the thread is done with this service
+    services.removeFirstMatchingValue(service);
+}
+
+void CoefficientDesignThread::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* service : services)
+                service->designIfDirty();
+        }
+        wait(pollIntervalMs); //polling keeps the audio thread free of any signalling
+    }
+}
+
+//==============================================================================
+CoefficientService::CoefficientService(juce::AudioProcessorValueTreeState& state) : apvts(state)
+{
+    for (auto* parameter : apvts.processor.getParameters()) //any parameter change means the coefficients are stale
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            apvts.addParameterListener(withID->paramID, this);
+
+    designThread->add(this);
+}
+
+CoefficientService::~CoefficientService()
+{
+    designThread->remove(this);
+
+    for (auto* parameter : apvts.processor.getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            apvts.removeParameterListener(withID->paramID, this);
+}
+
+void CoefficientService::prepare(double newSampleRate)
+{
+    {
+        const juce::ScopedLock sl(producerLock);
+        sampleRate = newSampleRate;
+
+        if (! dirty.load() && latestVersion.load() > 0 && latestSampleRate == newSampleRate) //e.g. a session restored before its first prepare
+            publish(latest, latestSampleRate);
+        else
+            publish(designFromParameters(newSampleRate), newSampleRate);
+    }
+
+    notifyListenerIfPending(); //outside the lock, like designNow()
+}
+
+void CoefficientService::parameterChanged(const juce::String&, float)
+{
+    dirty = true; //may be called from the audio thread so all we do is raise a flag
+}
+
+void CoefficientService::designIfDirty()
+{
+    if (dirty.load() && sampleRate.load() > 0.0)
+        designNow();
+
+    notifyListenerIfPending(); //a predesigned set is published on the caller's thread, but the listener's work is done here
+}
+
+void CoefficientService::designNow()
+{
+    const auto rate = sampleRate.load();
+    if (rate <= 0.0)
+        return;
+
+    {
+        const juce::ScopedLock sl(producerLock);
+        publish(designFromParameters(rate), rate);
+    }
+
+    notifyListenerIfPending();
+}
+
+void CoefficientService::notifyListenerIfPending()
+{
+    const juce::ScopedLock sl(listenerLock);
+    if (listener == nullptr || ! listenerPending.exchange(false))
+        return;
+
+    listener->chainCoefficientsDesigned(getLatestCoefficients()); //a copy, producers can publish again while the listener works
+}
+
+ChainCoefficients CoefficientService::designFromParameters(double rate)
+{
+    dirty = false; //cleared before reading so a change that lands mid-design triggers another pass
+    const auto changes = changeCount.load(); //after the flag, every change up to here is in what we read
+
+    auto coefficients = makeChainCoefficients(getChainSettings(apvts), rate);
+    coefficients.changesCovered = changes;
+    return coefficients;
+}
+
+void CoefficientService::publish(ChainCoefficients coefficients, double designedSampleRate)
+{
+    coefficients.version = nextVersion++;
+    coefficients.isRecall = coefficients.isRecall || recallPending;
+    recallPending = false;
+    buffer.getWriteBuffer() = coefficients;
+    buffer.publish();
+    latest = coefficients;
+    latestSampleRate = designedSampleRate;
+    latestVersion = coefficients.version;
+    listenerPending = true;
+}
+
+void CoefficientService::setListener(Listener* newListener)
+{
+    const juce::ScopedLock sl(listenerLock);
+    listener = newListener;
+}
+
+ChainCoefficients CoefficientService::getLatestCoefficients(double* designedSampleRate) const
+{
+    const juce::ScopedLock sl(producerLock);
+    if (designedSampleRate != nullptr)
+        *designedSampleRate = latestSampleRate;
+
+    return latest;
+}
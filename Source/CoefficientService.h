@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    CoefficientService.h
+
+    Designs the peak and cut filter coefficients away from the audio thread
+    and hands them to processBlock through a lock-free triple buffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+//==============================================================================
+/** Single producer / single consumer triple buffer.
+    The writer fills getWriteBuffer() and calls publish(), the reader calls acquire()
+    and reads getReadBuffer(). Neither side ever waits on the other.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    T& getWriteBuffer() noexcept { return buffers[(size_t) writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange (writeIndex | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    bool acquire() noexcept //returns true if the read buffer was swapped for newer data
+    {
+        if ((middle.load (std::memory_order_relaxed) & newDataBit) == 0)
+            return false;
+
+        readIndex = middle.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return buffers[(size_t) readIndex]; }
+
+    template <typename Function>
+    void forEachBuffer(Function&& function) //only while neither side is running, e.g. to allocate in prepareToPlay
+    {
+        for (auto& b : buffers)
+            function(b);
+    }
+
+private:
+    static constexpr int indexMask = 3, newDataBit = 4;
+    std::array<T, 3> buffers;
+    int writeIndex{ 0 }, readIndex{ 1 };
+    std::atomic<int> middle{ 2 };
+};
+
+//==============================================================================
+class CoefficientService;
+
+/** Background thread shared by all CoefficientService instances in the process. */
+class CoefficientDesignThread : private juce::Thread
+{
+public:
+    CoefficientDesignThread();
+    ~CoefficientDesignThread() override;
+
+    void add (CoefficientService* service);
+    void remove (CoefficientService* service);
+
+private:
+    void run() override;
+
+    static constexpr int pollIntervalMs = 5;
+    juce::CriticalSection lock;
+    juce::Array<CoefficientService*> services;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientDesignThread)
+};
+
+//==============================================================================
+/** Watches the APVTS and redesigns the chain coefficients on a background thread
+    whenever a parameter moves. The audio thread only ever calls pull().
+*/
+class CoefficientService : private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+    explicit CoefficientService (juce::AudioProcessorValueTreeState& apvts);
+    ~CoefficientService() override;
+
+    void prepare (double sampleRate); //designs a first set synchronously, unless a restored design for this rate is waiting
+    bool isDirty() const noexcept { return dirty.load(); }
+    void designNow(); //synchronous redesign and listener call, used when the host renders offline
+    void designIfDirty(); //design thread, also passes on a predesigned set to the listener
+    void notifyListenerIfPending(); //the listener hears about the newest set now, if it hasn't yet
+    /** For values that changed without the APVTS hearing about it, real-time safe. Returns the change's count,
+        a published set includes the change once its changesCovered has reached it.
+    */
+    juce::uint32 markDirty() noexcept
+    {
+        const auto count = ++changeCount; //before the flag, so a design that reads the count without it is followed by another
+        dirty = true;
+        return count;
+    }
+
+    /** Publishes coefficients that were designed ahead of time (a preset or a saved state) instead of designing them.
+        setParameters moves the parameters to match, the changes it causes don't trigger a redesign.
+        With designed == nullptr, or a design for another rate, the parameters are set and the design thread designs as usual.
+        Either way the listener is called from the design thread, the caller doesn't wait for the work it does.
+    */
+    template <typename Function>
+    void applyPredesigned (const ChainCoefficients* designed, double designedSampleRate, Function&& setParameters)
+    {
+        const juce::ScopedLock sl(producerLock);
+        setParameters();
+
+        const auto rate = sampleRate.load();
+        if (designed != nullptr && (rate == designedSampleRate || rate <= 0.0)) //before the first prepare, prepare() checks the rate
+        {
+            auto recalled = *designed;
+            recalled.isRecall = true;
+            recalled.changesCovered = changeCount.load(); //setParameters just wrote every value the design is for
+            dirty = false;
+            publish(recalled, designedSampleRate);
+        }
+        else
+        {
+            recallPending = dirty.load(); //the design thread's next design is the recall, unless nothing moved
+        }
+    }
+
+    /** Gets told about new designs, for work that builds on the coefficients. Called without producerLock held, on the design
+        thread or in designNow(), so a slow listener never holds up a publish. Sets published close together may only be told once, as the newest.
+    */
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void chainCoefficientsDesigned (const ChainCoefficients& coefficients) = 0;
+    };
+
+    void setListener (Listener* newListener); //waits for a listener call in progress
+
+    /** For the editor. The version changes with every design, so it can tell whether its copy is stale without taking the lock. */
+    juce::uint32 getLatestVersion() const noexcept { return latestVersion.load(); }
+    ChainCoefficients getLatestCoefficients (double* designedSampleRate = nullptr) const;
+
+    /** Audio thread only. Returns the newest coefficients, or nullptr if nothing changed since the last call. */
+    const ChainCoefficients* pull() noexcept
+    {
+        return buffer.acquire() ? &buffer.getReadBuffer() : nullptr;
+    }
+
+private:
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    ChainCoefficients designFromParameters (double rate); //producerLock must be held, clears the dirty flag before reading
+    void publish (ChainCoefficients coefficients, double designedSampleRate); //producerLock must be held, the listener is told later
+
+    juce::AudioProcessorValueTreeState& apvts;
+    std::atomic<double> sampleRate{ 0.0 };
+    std::atomic<bool> dirty{ true };
+    std::atomic<juce::uint32> changeCount{ 0 }; //bumped by markDirty()
+    juce::uint32 nextVersion{ 1 };
+    bool recallPending{ false }; //guarded by producerLock, the next design publishes a program change or restored state
+
+    juce::CriticalSection producerLock; //only ever taken by the writers, never by the audio thread
+    TripleBuffer<ChainCoefficients> buffer;
+    juce::CriticalSection listenerLock; //held while the listener runs, so setListener can wait for it
+    Listener* listener{ nullptr }; //guarded by listenerLock
+    std::atomic<bool> listenerPending{ false }; //a set was published the listener hasn't heard about
+    ChainCoefficients latest; //guarded by producerLock
+    double latestSampleRate{ 0.0 };
+    std::atomic<juce::uint32> latestVersion{ 0 };
+
+    juce::SharedResourcePointer<CoefficientDesignThread> designThread; //one thread shared by every instance
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientService)
+};
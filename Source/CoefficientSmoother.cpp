@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    CoefficientSmoother.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientSmoother.h"
+
+static void interpolate(const BiquadCoefficients& from, const BiquadCoefficients& to, float amount, BiquadCoefficients& result) noexcept
+{
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = from[i] + (to[i] - from[i]) * amount;
+}
+
+template <size_t Size>
+static void interpolate(const std::array<float, Size>& from, const std::array<float, Size>& to, float amount, std::array<float, Size>& result) noexcept
+{
+    for (size_t i = 0; i < Size; ++i) //every band slot, enabled or not - identity to identity stays identity
+        result[i] = from[i] + (to[i] - from[i]) * amount;
+}
+
+void CoefficientSmoother::setTarget(const ChainCoefficients& newTarget, int rampLengthInSamples) noexcept
+{
+    if (hasCoefficients && isSameDesign(newTarget, target)) //e.g. the service catching up with a design the processor already made
+        return;
+
+    //designs for another oversampling factor are for another sample rate, there's no line between the two to ramp along.
+    //The processor keeps a chain, and a smoother, per rate
+    jassert(! hasCoefficients || newTarget.oversamplingFactor == target.oversamplingFactor);
+    target = newTarget;
+    needsApply = true;
+
+    if (! hasCoefficients || rampLengthInSamples <= 0)
+    {
+        current = target;
+        stepsRemaining = 0;
+        position = 0;
+        hasCoefficients = true;
+        return;
+    }
+
+    start = current; //a new target halfway through a ramp carries on from where we got to
+    totalSteps = stepsRemaining = (rampLengthInSamples + subBlockSize - 1) / subBlockSize;
+    position = 0; //and the sub-blocks count from here
+}
+
+const ChainCoefficients* CoefficientSmoother::next() noexcept
+{
+    if (stepsRemaining > 0 && position == 0)
+    {
+        --stepsRemaining;
+
+        if (stepsRemaining == 0)
+        {
+            current = target;
+        }
+        else
+        {
+            const auto amount = 1.f - (float) stepsRemaining / (float) totalSteps;
+            interpolate(start.bands.b0, target.bands.b0, amount, current.bands.b0);
+            interpolate(start.bands.b1, target.bands.b1, amount, current.bands.b1);
+            interpolate(start.bands.b2, target.bands.b2, amount, current.bands.b2);
+            interpolate(start.bands.a1, target.bands.a1, amount, current.bands.a1);
+            interpolate(start.bands.a2, target.bands.a2, amount, current.bands.a2);
+
+            for (size_t i = 0; i < current.lowCut.size(); ++i)
+            {
+                interpolate(start.lowCut[i], target.lowCut[i], amount, current.lowCut[i]);
+                interpolate(start.highCut[i], target.highCut[i], amount, current.highCut[i]);
+            }
+
+            //keep every stage that is fading in or out running until the ramp is over
+            current.lowCutSlope = juce::jmax(start.lowCutSlope, target.lowCutSlope);
+            current.highCutSlope = juce::jmax(start.highCutSlope, target.highCutSlope);
+        }
+
+        needsApply = false;
+        return &current;
+    }
+
+    if (needsApply)
+    {
+        needsApply = false;
+        return &current;
+    }
+
+    return nullptr;
+}
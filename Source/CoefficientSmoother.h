@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    CoefficientSmoother.h
+
+    Ramps the chain coefficients towards the newest design one sub-block at a
+    time instead of jumping once per host block. The sub-blocks run on from
+    where the ramp started, across host block boundaries, so how the host
+    slices the audio doesn't change where the coefficients move.
+
+    The biquads are interpolated directly. A biquad is stable when (a1, a2)
+    lies inside the stability triangle, and the triangle is convex, so every
+    point on a straight line between two stable designs is stable too. Stages
+    that a slope change switches on or off ramp from or to identity.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+class CoefficientSmoother
+{
+public:
+    static constexpr int subBlockSize = 32; //coefficients move every 32 samples while ramping
+
+    /** Starts a ramp from wherever we are now. A ramp length of 0 (or the first set after reset) jumps straight there.
+        Ramp lengths are in samples at the design's oversampled rate, and every design until the next reset has to be
+        for the same factor. The design we are already heading for changes nothing, a ramp that is running carries on as it was.
+    */
+    void setTarget(const ChainCoefficients& newTarget, int rampLengthInSamples) noexcept;
+
+    void reset() noexcept { hasCoefficients = false; stepsRemaining = 0; position = 0; }
+
+    bool isSmoothing() const noexcept { return stepsRemaining > 0; }
+    bool hasTarget() const noexcept { return hasCoefficients; }
+    const ChainCoefficients& getTarget() const noexcept { return target; } //the design the ramp ends on
+
+    /** Moves the ramp on by a sub-block when one starts here. Returns the coefficients to load, or nullptr if nothing changed. */
+    const ChainCoefficients* next() noexcept;
+
+    /** Samples until the next sub-block starts, process no more than this before calling next() again while smoothing. */
+    int getSamplesUntilNextStep() const noexcept { return subBlockSize - position; }
+
+    /** Call after processing numSamples with the coefficients next() handed out. */
+    void advance(int numSamples) noexcept { position = isSmoothing() ? (position + numSamples) % subBlockSize : 0; }
+
+private:
+    ChainCoefficients start, target, current;
+    int stepsRemaining{ 0 }, totalSteps{ 0 };
+    int position{ 0 }; //samples into the current sub-block
+    bool hasCoefficients{ false }, needsApply{ false };
+};
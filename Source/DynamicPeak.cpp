@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+
+DynamicParameters::DynamicParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    enabled = apvts.getRawParameterValue("Peak Dynamic");
+    useSidechain = apvts.getRawParameterValue("Peak Sidechain");
+    threshold = apvts.getRawParameterValue("Peak Threshold");
+    ratio = apvts.getRawParameterValue("Peak Ratio");
+    attack = apvts.getRawParameterValue("Peak Attack");
+    release = apvts.getRawParameterValue("Peak Release");
+}
+
+DynamicSettings DynamicParameters::read() const noexcept
+{
+    DynamicSettings settings;
+    settings.enabled = enabled->load() > 0.5f;
+    settings.useSidechain = useSidechain->load() > 0.5f;
+    settings.thresholdInDecibels = threshold->load();
+    settings.ratio = ratio->load();
+    settings.attackMs = attack->load();
+    settings.releaseMs = release->load();
+    return settings;
+}
+
+//==============================================================================
+void DynamicPeak::prepare(double newSampleRate, int numChannels)
+{
+    sampleRate = newSampleRate;
+    states.assign((size_t) numChannels, State());
+    lastFrequency = lastQuality = 0.f; //works the band out again at the new rate
+    settings = {};
+    settings.attackMs = settings.releaseMs = -1.f; //and the envelope coefficients
+    reset();
+}
+
+void DynamicPeak::reset() noexcept
+{
+    std::fill(states.begin(), states.end(), State());
+    detectorState = {};
+    bell = {};
+    envelope = intervalPeak = 0.f;
+    reductionInDecibels = 0.f;
+    position = 0;
+}
+
+void DynamicPeak::setParameters(float frequency, float quality, const DynamicSettings& newSettings) noexcept
+{
+    if (newSettings.enabled && ! settings.enabled && ! isReducing())
+        reset(); //the envelope starts from nothing rather than from whatever it last heard
+
+    if (frequency != lastFrequency || quality != lastQuality)
+    {
+        lastFrequency = frequency;
+        lastQuality = quality;
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jlimit(2.0, 0.49 * sampleRate, (double) frequency) / sampleRate;
+        minusTwoCos = (float) (-2.0 * std::cos(omega));
+        alpha = (float) (std::sin(omega) / (2.0 * quality));
+
+        //the cookbook's constant 0 dB peak band pass, so the detector reads the band's level in dBFS
+        const auto a0 = 1.f + alpha;
+        detector = { alpha / a0, 0.f, -alpha / a0, minusTwoCos / a0, (1.f - alpha) / a0 };
+    }
+
+    if (newSettings.attackMs != settings.attackMs || newSettings.releaseMs != settings.releaseMs)
+    {
+        auto perInterval = [this](float ms) { return (float) std::exp(-controlInterval / (juce::jmax(0.01, (double) ms) * 0.001 * sampleRate)); };
+        attack = perInterval(newSettings.attackMs);
+        release = perInterval(newSettings.releaseMs);
+    }
+
+    settings = newSettings; //the new frequency and Q reach the bell with the next gain update
+}
+
+void DynamicPeak::updateGain() noexcept
+{
+    //switched off, the envelope hears nothing and releases the band on its own
+    const auto level = settings.enabled ? intervalPeak : 0.f;
+    envelope = level + (level > envelope ? attack : release) * (envelope - level);
+    intervalPeak = 0.f;
+
+    //a compressor's static curve, on the band only: everything above the threshold comes out ratio times smaller
+    const auto over = juce::Decibels::gainToDecibels(envelope, -120.f) - settings.thresholdInDecibels;
+    reductionInDecibels = over > 0.f ? juce::jmax(-maxCutInDecibels, over * (1.f / settings.ratio - 1.f)) : 0.f;
+
+    if (! isReducing())
+    {
+        if (bell.b0 != 1.f || bell.a2 != 0.f)
+        {
+            bell = {}; //back at 0 dB the bell is identity and skipped, the next cut starts from rest
+            std::fill(states.begin(), states.end(), State());
+        }
+        return;
+    }
+
+    //makePeakFilter's design with the frequency terms already worked out, A is the square root of the gain
+    const auto a = std::exp(reductionInDecibels * (std::log(10.f) / 40.f));
+    const auto alphaTimesA = alpha * a, alphaOverA = alpha / a;
+    const auto scale = 1.f / (1.f + alphaOverA);
+    bell = { (1.f + alphaTimesA) * scale, minusTwoCos * scale, (1.f - alphaTimesA) * scale, minusTwoCos * scale, (1.f - alphaOverA) * scale };
+}
+
+void DynamicPeak::process(const juce::dsp::AudioBlock<float>& block, const juce::dsp::AudioBlock<const float>& key) noexcept
+{
+    jassert(block.getNumChannels() <= states.size()); //prepare() sized the states for fewer channels
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = juce::jmin(block.getNumChannels(), states.size());
+    const auto numKeyChannels = key.getNumChannels();
+    const auto keyGain = numKeyChannels > 0 ? 1.f / (float) numKeyChannels : 0.f; //the mean, so a stereo key reads like a mono one
+
+    for (size_t start = 0; start < numSamples;)
+    {
+        const auto end = start + juce::jmin((size_t) (controlInterval - position), numSamples - start);
+
+        //the key is read before the bell writes, so the block itself can be the key
+        auto peak = intervalPeak;
+        auto s1 = detectorState.s1, s2 = detectorState.s2;
+        for (auto i = start; i < end; ++i)
+        {
+            auto x = 0.f;
+            for (size_t channel = 0; channel < numKeyChannels; ++channel)
+                x += key.getChannelPointer(channel)[i];
+            x *= keyGain;
+
+            const auto y = detector.b0 * x + s1;
+            s1 = s2 - detector.a1 * y; //b1 is 0
+            s2 = detector.b2 * x - detector.a2 * y;
+            peak = juce::jmax(peak, std::abs(y));
+        }
+        intervalPeak = peak;
+        detectorState = { s1, s2 };
+
+        if (isReducing()) //at 0 dB the bell is identity and skipped altogether
+        {
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* samples = block.getChannelPointer(channel);
+                auto state = states[channel];
+                for (auto i = start; i < end; ++i)
+                {
+                    const auto x = samples[i];
+                    const auto y = bell.b0 * x + state.s1;
+                    state.s1 = bell.b1 * x - bell.a1 * y + state.s2;
+                    state.s2 = bell.b2 * x - bell.a2 * y;
+                    samples[i] = y;
+                }
+                states[channel] = state;
+            }
+        }
+
+        position += (int) (end - start);
+        start = end;
+
+        if (position == controlInterval)
+        {
+            position = 0;
+            updateGain();
+        }
+    }
+}
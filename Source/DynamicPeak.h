@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+
+    The Peak band's dynamic mode: an envelope follower listening to the main
+    input or the sidechain bus, through a band pass on the band so only what
+    the band could act on counts, turns the band down like a compressor with
+    threshold, ratio, attack and release.
+
+    The gain moves every controlInterval samples, far too often for
+    makePeakFilter and its heap allocated Coefficients, so the moving part is
+    a bell of its own at the band's frequency and Q, on top of the static
+    band. With the frequency and Q fixed the cookbook bell is a closed form
+    in the gain: cos w and alpha are worked out once per block, and a gain
+    update is an exp and one division. The envelope runs at the same rate,
+    on the peak of each interval, so per sample all that's left is the band
+    pass and one biquad per channel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct DynamicSettings
+{
+    bool enabled{ false }, useSidechain{ false };
+    float thresholdInDecibels{ -24.f }, ratio{ 4.f }, attackMs{ 5.f }, releaseMs{ 100.f };
+};
+
+/** The dynamic mode's parameters, looked up once like ChainParameters. */
+struct DynamicParameters
+{
+    explicit DynamicParameters(juce::AudioProcessorValueTreeState& apvts);
+    DynamicSettings read() const noexcept; //real-time safe
+
+    std::atomic<float> *enabled, *useSidechain, *threshold, *ratio, *attack, *release;
+};
+
+class DynamicPeak
+{
+public:
+    static constexpr int controlInterval = 16; //samples between gain updates, like the smoother's sub-blocks but shorter
+    static constexpr float maxCutInDecibels = 24.f; //as far as the band's own gain goes
+
+    void prepare(double sampleRate, int numChannels); //allocates the states, call from prepareToPlay only
+    void reset() noexcept;
+
+    /** Audio thread, once per block. The band's frequency and Q are the static Peak's. */
+    void setParameters(float frequency, float quality, const DynamicSettings& settings) noexcept;
+    bool isEnabled() const noexcept { return settings.enabled; }
+
+    /** True while the band is turned down at all. Switched off, the reduction releases back to 0 dB rather than jumping. */
+    bool isReducing() const noexcept { return reductionInDecibels < 0.f; }
+
+    /** key is what the envelope follows, either the block itself (before anything else touched it) or the sidechain.
+        Every key channel is mixed down, so the channel counts don't have to match.
+    */
+    void process(const juce::dsp::AudioBlock<float>& block, const juce::dsp::AudioBlock<const float>& key) noexcept;
+
+private:
+    struct Biquad { float b0{ 1.f }, b1{ 0.f }, b2{ 0.f }, a1{ 0.f }, a2{ 0.f }; }; //a0 normalised, identity by default
+    struct State { float s1{ 0.f }, s2{ 0.f }; }; //transposed direct form II, as juce::dsp::IIR::Filter
+
+    void updateGain() noexcept; //envelope -> gain -> the bell for the next interval
+
+    double sampleRate{ 44100.0 };
+    DynamicSettings settings;
+    float lastFrequency{ 0.f }, lastQuality{ 0.f }; //what the terms below were worked out from
+    float minusTwoCos{ -2.f }, alpha{ 0.f }; //the cookbook's -2 cos w and sin w / 2Q
+    float attack{ 0.f }, release{ 0.f }; //one pole coefficients per interval
+
+    Biquad detector, bell;
+    State detectorState;
+    std::vector<State> states; //one per channel
+
+    float envelope{ 0.f }, intervalPeak{ 0.f };
+    float reductionInDecibels{ 0.f };
+    int position{ 0 }; //samples into the current control interval, intervals run across block boundaries
+};
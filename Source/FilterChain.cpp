@@ -0,0 +1,339 @@
+/*
+  ==============================================================================
+
+    FilterChain.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterChain.h"
+#include "ParameterInfo.h"
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    return ChainParameters(apvts).read();
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    lowCutFreq = apvts.getRawParameterValue("LowCut Freq"); //getRawParamValue returns the value in units that are meaningful (db,Hz, db/oct) rather than normalized values
+    highCutFreq = apvts.getRawParameterValue("HighCut Freq");
+    lowCutSlope = apvts.getRawParameterValue("LowCut Slope");
+    highCutSlope = apvts.getRawParameterValue("HighCut Slope");
+    oversampling = apvts.getRawParameterValue("Oversampling");
+
+    for (int i = 0; i < maxNumBands; ++i)
+    {
+        auto& band = bands[(size_t) i];
+        const auto& ids = getBandParameterIDs(i); //shared, so a new instance doesn't format 160 IDs to look them up
+        band.enabled = apvts.getRawParameterValue(ids.enabled);
+        band.type = apvts.getRawParameterValue(ids.type);
+        band.freq = apvts.getRawParameterValue(ids.freq);
+        band.gain = apvts.getRawParameterValue(ids.gain);
+        band.quality = apvts.getRawParameterValue(ids.quality);
+    }
+}
+
+ChainSettings ChainParameters::read() const noexcept
+{
+    ChainSettings settings;
+    settings.lowCutFreq = lowCutFreq->load(); //loads the param values into an instance of the struct
+    settings.highCutFreq = highCutFreq->load();
+
+    for (int i = 0; i < maxNumBands; ++i)
+    {
+        const auto& parameters = bands[(size_t) i];
+        auto& band = settings.bands[(size_t) i];
+        band.enabled = parameters.enabled->load() > 0.5f;
+        band.type = (int) parameters.type->load();
+        band.freq = parameters.freq->load();
+        band.gainInDecibels = parameters.gain->load();
+        band.quality = parameters.quality->load();
+    }
+
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->load());
+    settings.oversampling = 1 << (int) oversampling->load(); //the choices are Off, 2x, 4x and 8x
+    return settings;
+}
+
+bool operator==(const ChainSettings& a, const ChainSettings& b) noexcept
+{
+    auto sameBand = [](const BandSettings& x, const BandSettings& y)
+    {
+        return x.enabled == y.enabled && x.type == y.type && x.freq == y.freq && x.gainInDecibels == y.gainInDecibels && x.quality == y.quality;
+    };
+
+    return std::equal(a.bands.begin(), a.bands.end(), b.bands.begin(), sameBand)
+        && a.lowCutFreq == b.lowCutFreq && a.highCutFreq == b.highCutFreq
+        && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope
+        && a.oversampling == b.oversampling;
+}
+
+int getOversamplingFactor(const ChainSettings& settings, double sampleRate) noexcept
+{
+    if (settings.oversampling <= 1)
+        return 1;
+
+    //the cuts count too, a Butterworth's corner is pulled down towards Nyquist just the same
+    const auto crampedAbove = (float) (crampingFrequencyRatio * sampleRate);
+    auto isCramped = (! isLowCutOff(settings, sampleRate) && settings.lowCutFreq > crampedAbove)
+                  || (! isHighCutOff(settings, sampleRate) && settings.highCutFreq > crampedAbove);
+
+    for (const auto& band : settings.bands)
+        isCramped = isCramped || (! isBandIdentity(band) && band.freq > crampedAbove);
+
+    return isCramped ? juce::jmin(settings.oversampling, maxOversamplingFactor) : 1;
+}
+
+juce::String getBandParameterID(int band, const juce::String& name)
+{
+    return (band == 0 ? juce::String("Peak ") : "Band " + juce::String(band + 1) + " ") + name;
+}
+
+int getBandOfParameter(const juce::String& parameterID)
+{
+    if (parameterID.startsWith("Peak "))
+        return 0;
+
+    if (parameterID.startsWith("Band "))
+        return parameterID.fromFirstOccurrenceOf("Band ", false, false).getIntValue() - 1;
+
+    return -1;
+}
+
+Coefficients makeBandFilter(const BandSettings& band, double sampleRate)
+{
+    using IIRCoefficients = juce::dsp::IIR::Coefficients<float>;
+    const auto gain = juce::Decibels::decibelsToGain(band.gainInDecibels);
+
+    switch (band.type)
+    {
+    case Band_LowShelf:
+        return IIRCoefficients::makeLowShelf(sampleRate, band.freq, band.quality, gain);
+    case Band_HighShelf:
+        return IIRCoefficients::makeHighShelf(sampleRate, band.freq, band.quality, gain);
+    case Band_Notch:
+        return IIRCoefficients::makeNotch(sampleRate, band.freq, band.quality);
+    default:
+        return IIRCoefficients::makePeakFilter(sampleRate, band.freq, band.quality, gain); // sets up peak/bandpass filter
+    }
+}
+
+void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+{
+    *old = *replacements;
+}
+
+void updateCoefficients(Coefficients& old, const BiquadCoefficients& replacements)
+{
+    jassert(old->coefficients.size() == (int) replacements.size()); //prepareChain() makes sure of this
+    std::copy(replacements.begin(), replacements.end(), old->coefficients.begin());
+}
+
+//the formulas of juce::dsp::IIR::Coefficients, in float like its Coefficients<float>, so every design
+//comes out the same whichever thread makes it and nothing touches the heap
+static BiquadCoefficients normalise(float b0, float b1, float b2, float a0, float a1, float a2) noexcept
+{
+    const auto a0Inverse = 1.f / a0;
+    return { b0 * a0Inverse, b1 * a0Inverse, b2 * a0Inverse, a1 * a0Inverse, a2 * a0Inverse };
+}
+
+static BiquadCoefficients makeLowPassBiquad(double sampleRate, float frequency, float quality) noexcept
+{
+    const auto n = 1.f / std::tan(juce::MathConstants<float>::pi * frequency / (float) sampleRate);
+    const auto nSquared = n * n;
+    const auto inverseQ = 1.f / quality;
+    const auto c1 = 1.f / (1.f + inverseQ * n + nSquared);
+    return { c1, c1 * 2.f, c1, c1 * 2.f * (1.f - nSquared), c1 * (1.f - inverseQ * n + nSquared) };
+}
+
+static BiquadCoefficients makeHighPassBiquad(double sampleRate, float frequency, float quality) noexcept
+{
+    const auto n = std::tan(juce::MathConstants<float>::pi * frequency / (float) sampleRate);
+    const auto nSquared = n * n;
+    const auto inverseQ = 1.f / quality;
+    const auto c1 = 1.f / (1.f + inverseQ * n + nSquared);
+    return { c1, c1 * -2.f, c1, c1 * 2.f * (nSquared - 1.f), c1 * (1.f - inverseQ * n + nSquared) };
+}
+
+BiquadCoefficients makeBandBiquad(const BandSettings& band, double sampleRate) noexcept
+{
+    const auto gain = juce::Decibels::decibelsToGain(band.gainInDecibels);
+    const auto a = juce::jmax(0.f, std::sqrt(gain));
+    const auto omega = 2.f * juce::MathConstants<float>::pi * juce::jmax(band.freq, 2.f) / (float) sampleRate;
+
+    switch (band.type)
+    {
+    case Band_LowShelf:
+    case Band_HighShelf:
+    {
+        const auto aMinus1 = a - 1.f, aPlus1 = a + 1.f;
+        const auto cosOmega = std::cos(omega);
+        const auto beta = std::sin(omega) * std::sqrt(a) / band.quality;
+        const auto aMinus1TimesCos = aMinus1 * cosOmega;
+
+        if (band.type == Band_LowShelf)
+            return normalise(a * (aPlus1 - aMinus1TimesCos + beta), a * 2.f * (aMinus1 - aPlus1 * cosOmega), a * (aPlus1 - aMinus1TimesCos - beta),
+                             aPlus1 + aMinus1TimesCos + beta, -2.f * (aMinus1 + aPlus1 * cosOmega), aPlus1 + aMinus1TimesCos - beta);
+
+        return normalise(a * (aPlus1 + aMinus1TimesCos + beta), a * -2.f * (aMinus1 + aPlus1 * cosOmega), a * (aPlus1 + aMinus1TimesCos - beta),
+                         aPlus1 - aMinus1TimesCos + beta, 2.f * (aMinus1 - aPlus1 * cosOmega), aPlus1 - aMinus1TimesCos - beta);
+    }
+    case Band_Notch:
+    {
+        const auto n = 1.f / std::tan(juce::MathConstants<float>::pi * band.freq / (float) sampleRate);
+        const auto nSquared = n * n;
+        const auto inverseQ = 1.f / band.quality;
+        const auto c1 = 1.f / (1.f + n * inverseQ + nSquared);
+        const auto b0 = c1 * (1.f + nSquared);
+        const auto b1 = 2.f * c1 * (1.f - nSquared);
+        return { b0, b1, b0, b1, c1 * (1.f - n * inverseQ + nSquared) };
+    }
+    default:
+    {
+        const auto alpha = std::sin(omega) / (band.quality * 2.f);
+        const auto c2 = -2.f * std::cos(omega);
+        const auto alphaTimesA = alpha * a, alphaOverA = alpha / a;
+        return normalise(1.f + alphaTimesA, c2, 1.f - alphaTimesA, 1.f + alphaOverA, c2, 1.f - alphaOverA);
+    }
+    }
+}
+
+template <typename MakeSection>
+static void designButterworth(std::array<BiquadCoefficients, 4>& stages, int slope, MakeSection&& makeSection) noexcept
+{
+    //as FilterDesign's high order Butterworth methods: one section per 12 dB, each pair of poles with its own Q
+    stages.fill(identityBiquad); //the stages above the slope stay identity
+    const auto order = (slope + 1) * 2;
+    for (int i = 0; i < order / 2; ++i)
+        stages[(size_t) i] = makeSection((float) (1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)))));
+}
+
+bool isLowCutOff(const ChainSettings& settings, double) noexcept
+{
+    return settings.lowCutFreq <= minAudibleFrequency;
+}
+
+bool isHighCutOff(const ChainSettings& settings, double sampleRate) noexcept
+{
+    //below a 40 kHz rate the audible band stops at Nyquist, a corner past it has nothing left to cut
+    return settings.highCutFreq >= juce::jmin(maxAudibleFrequency, 0.5 * sampleRate);
+}
+
+void designBand(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band, double sampleRate) noexcept
+{
+    const auto& settings = chainSettings.bands[(size_t) band];
+
+    //disabled and 0 dB bands stay exactly identity, which is what marks them inactive
+    coefficients.bands.set(band, isBandIdentity(settings) ? identityBiquad : makeBandBiquad(settings, sampleRate));
+}
+
+void designLowCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    coefficients.lowCutSlope = isLowCutOff(chainSettings, sampleRate) ? (int) Slope_Off : chainSettings.lowCutSlope;
+    designButterworth(coefficients.lowCut, coefficients.lowCutSlope, [&](float quality) { return makeHighPassBiquad(sampleRate, chainSettings.lowCutFreq, quality); });
+}
+
+void designHighCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    coefficients.highCutSlope = isHighCutOff(chainSettings, sampleRate) ? (int) Slope_Off : chainSettings.highCutSlope;
+    designButterworth(coefficients.highCut, coefficients.highCutSlope, [&](float quality) { return makeLowPassBiquad(sampleRate, chainSettings.highCutFreq, quality); });
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    return makeChainCoefficients(chainSettings, sampleRate, getOversamplingFactor(chainSettings, sampleRate));
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate, int oversamplingFactor) noexcept
+{
+    ChainCoefficients coefficients; //stages the slope doesn't use are left as identity so the smoother can ramp them in and out
+    coefficients.oversamplingFactor = oversamplingFactor;
+    const auto designRate = sampleRate * coefficients.oversamplingFactor;
+
+    for (int i = 0; i < maxNumBands; ++i)
+        designBand(coefficients, chainSettings, i, designRate);
+
+    designLowCut(coefficients, chainSettings, designRate);
+    designHighCut(coefficients, chainSettings, designRate);
+    return coefficients;
+}
+
+bool isSameDesign(const ChainCoefficients& a, const ChainCoefficients& b) noexcept
+{
+    return a.bands.b0 == b.bands.b0 && a.bands.b1 == b.bands.b1 && a.bands.b2 == b.bands.b2 && a.bands.a1 == b.bands.a1 && a.bands.a2 == b.bands.a2
+        && a.lowCut == b.lowCut && a.highCut == b.highCut && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope
+        && a.oversamplingFactor == b.oversamplingFactor;
+}
+
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate) noexcept
+{
+    const auto z1 = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate); //z^-1 on the unit circle
+    const auto z2 = z1 * z1;
+    const auto numerator = (double) coefficients[0] + (double) coefficients[1] * z1 + (double) coefficients[2] * z2;
+    const auto denominator = 1.0 + (double) coefficients[3] * z1 + (double) coefficients[4] * z2;
+    return std::abs(numerator / denominator);
+}
+
+double getChainMagnitudeForFrequency(const ChainCoefficients& coefficients, double frequency, double sampleRate) noexcept
+{
+    auto magnitude = 1.0;
+    sampleRate *= coefficients.oversamplingFactor; //the rate the stages were designed for
+
+    for (int band = 0; band < maxNumBands; ++band)
+        if (coefficients.isBandActive(band))
+            magnitude *= getMagnitudeForFrequency(coefficients.bands.get(band), frequency, sampleRate);
+
+    for (int i = 0; i <= coefficients.lowCutSlope; ++i)
+        magnitude *= getMagnitudeForFrequency(coefficients.lowCut[(size_t) i], frequency, sampleRate);
+
+    for (int i = 0; i <= coefficients.highCutSlope; ++i)
+        magnitude *= getMagnitudeForFrequency(coefficients.highCut[(size_t) i], frequency, sampleRate);
+
+    return magnitude;
+}
+
+static double getPoleRadius(const BiquadCoefficients& coefficients) noexcept
+{
+    //the poles are the roots of z^2 + a1 z + a2
+    const auto a1 = (double) coefficients[3], a2 = (double) coefficients[4];
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt(a2); //a complex pair, both at |p|^2 = a2
+
+    const auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+double getTailLengthInSamples(const ChainCoefficients& coefficients) noexcept
+{
+    //a stage's impulse response dies away like r^n for its largest pole radius r, and as the stages
+    //run one after the other their tails add up
+    const auto decay = std::log(1.0e-6); //-120 dB, well below anything the states could still add to the output
+    auto tail = 0.0;
+
+    auto addStage = [&tail, decay](const BiquadCoefficients& stage)
+    {
+        const auto radius = getPoleRadius(stage);
+        if (radius >= 1.0)
+            tail = std::numeric_limits<double>::infinity(); //not stable, never rings out
+        else if (radius > 0.0)
+            tail += decay / std::log(radius);
+
+        tail += 2.0; //the two samples of state even an FIR stage holds on to
+    };
+
+    for (int band = 0; band < maxNumBands; ++band)
+        if (coefficients.isBandActive(band))
+            addStage(coefficients.bands.get(band));
+
+    for (int i = 0; i <= coefficients.lowCutSlope; ++i)
+        addStage(coefficients.lowCut[(size_t) i]);
+
+    for (int i = 0; i <= coefficients.highCutSlope; ++i)
+        addStage(coefficients.highCut[(size_t) i]);
+
+    return tail / coefficients.oversamplingFactor; //counted at the oversampled rate
+}
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    FilterChain.h
+
+    The parameter snapshot, the filter chain types and the helpers that design
+    and load their coefficients. Shared by the processor, the coefficient
+    service and the SIMD channel groups.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+enum Slope
+{
+    Slope_Off = -1, //never a parameter value, ChainCoefficients use it for a cut that is left out of the chain
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48,
+};
+
+constexpr int maxNumBands = 32; //every band has its own set of parameters, enabled or not
+
+enum BandType
+{
+    Band_Peak,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_Notch,
+};
+
+struct BandSettings
+{
+    bool enabled{ false };
+    int type{ BandType::Band_Peak };
+    float freq{ 750.f }, gainInDecibels{ 0 }, quality{ 1.f };
+};
+
+struct ChainSettings // a data structure to store all the parameters from the AudioProcessor
+{
+    std::array<BandSettings, maxNumBands> bands; //bands[0] is the original peak, its parameters kept their IDs
+    float lowCutFreq{ 0 }, highCutFreq{ 0 };
+    int lowCutSlope{Slope::Slope_12}, highCutSlope{ Slope::Slope_12 };
+    int oversampling{ 1 }; //the factor asked for, 1 for off. Only used while a stage is cramped, see getOversamplingFactor
+};
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts); //Will return a struct with the values of our params
+bool operator==(const ChainSettings& a, const ChainSettings& b) noexcept;
+inline bool operator!=(const ChainSettings& a, const ChainSettings& b) noexcept { return ! (a == b); }
+
+/** The parameters behind ChainSettings, looked up by name once so the audio thread can take a snapshot without searching. */
+struct ChainParameters
+{
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+    ChainSettings read() const noexcept; //real-time safe, just atomic loads
+
+    struct Band { std::atomic<float> *enabled, *type, *freq, *gain, *quality; };
+    std::array<Band, maxNumBands> bands;
+    std::atomic<float> *lowCutFreq, *highCutFreq, *lowCutSlope, *highCutSlope, *oversampling;
+};
+juce::String getBandParameterID(int band, const juce::String& name); //"Peak Freq" for the first band, "Band 2 Freq" and so on for the others
+int getBandOfParameter(const juce::String& parameterID); //-1 if it isn't a band parameter
+
+//stages that would make no audible difference at these settings are left out of the chain altogether
+constexpr float minCutFrequency = 20.f, maxCutFrequency = 20000.f; //a cut parked at the end of its range is off
+constexpr double minAudibleFrequency = 20.0, maxAudibleFrequency = 20000.0;
+inline bool isBandIdentity(const BandSettings& band) noexcept
+{
+    return ! band.enabled || (band.type != Band_Notch && std::abs(band.gainInDecibels) < 0.01f); //a notch cuts whatever its gain says
+}
+
+/** True when the cut's corner sits on or past the edge of the audible band, Nyquist standing in for the top edge at rates below 40 kHz.
+    All such a cut does is take its 3 dB at the very edge, so it's left out whatever the slope. Real-time safe.
+*/
+bool isLowCutOff(const ChainSettings& settings, double sampleRate) noexcept;
+bool isHighCutOff(const ChainSettings& settings, double sampleRate) noexcept;
+
+//the bilinear transform squeezes a stage's curve together as it nears Nyquist, a bell gets narrower and a shelf steeper than asked for.
+//Designed at a multiple of the rate the stage sits well below the squeeze, everything else gains nothing from it
+constexpr int maxOversamplingFactor = 8;
+constexpr double crampingFrequencyRatio = 0.125; //of the sample rate, an octave below half Nyquist
+int getOversamplingFactor(const ChainSettings& settings, double sampleRate) noexcept; //settings.oversampling while an active stage is above the ratio, 1 otherwise
+
+struct ChainCoefficients // plain data so it can be copied around without touching the heap
+{
+    BiquadArrays<maxNumBands> bands; //one slot per band, disabled ones stay identity so the smoother can ramp them in and out
+    std::array<BiquadCoefficients, 4> lowCut{ identityBiquad, identityBiquad, identityBiquad, identityBiquad }; //up to 4 biquads for the 48 db/oct slope,
+    std::array<BiquadCoefficients, 4> highCut{ identityBiquad, identityBiquad, identityBiquad, identityBiquad }; //the stages above the slope stay identity
+    int lowCutSlope{ 0 }, highCutSlope{ 0 }; //Slope_Off when the cut is out of the chain
+    int oversamplingFactor{ 1 }; //the stages are designed for the sample rate times this, and run on audio resampled to it
+    juce::uint32 version{ 0 }; //bumped every time a new set gets published
+    juce::uint32 changesCovered{ 0 }; //the service's change count when it read the parameters, every markDirty() up to it is in the design
+    bool isRecall{ false }; //for a program change or a restored state, the audio thread crossfades to it over a fixed minimum
+
+    bool isBandActive(int band) const noexcept { return ! bands.isIdentity(band); } //an identity band is skipped
+    int getNumActiveBands() const noexcept
+    {
+        int numActive = 0;
+        for (int band = 0; band < maxNumBands; ++band)
+            numActive += isBandActive(band) ? 1 : 0;
+        return numActive;
+    }
+    int getNumActiveStages() const noexcept { return getNumActiveBands() + lowCutSlope + 1 + highCutSlope + 1; }
+};
+
+using Filter = juce::dsp::IIR::Filter<float>; //type alias
+using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>; //each filter is 12db/oct by default - this chain gives us 4x12 =4 8db/oct
+using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;//processor chains process all the audio its passed in a context with whats in your chain
+enum ChainPosition
+{
+    LowCut,
+    Peak,
+    Bands = Peak, //the MonoChain has its single peak filter where the channel groups run the band cascade
+    HighCut
+};
+
+using Coefficients = Filter::CoefficientsPtr;
+void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+void updateCoefficients(Coefficients& old, const BiquadCoefficients& replacements); //audio thread safe - copies in place, never allocates
+
+Coefficients makeBandFilter(const BandSettings& band, double sampleRate); //peak, shelf or notch
+inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, (chainSettings.lowCutSlope + 1) * 2);//slope(db/oct) of cutfilters known as its order - this helper function creates these filters
+}
+inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, (chainSettings.highCutSlope + 1) * 2);
+}
+
+/** The same designs as makeBandFilter, makeLowCutFilter and makeHighCutFilter, straight into plain data. Real-time safe. */
+BiquadCoefficients makeBandBiquad(const BandSettings& band, double sampleRate) noexcept;
+void designBand(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band, double sampleRate) noexcept; //only that band's slot
+void designLowCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate) noexcept; //the stages and the slope
+void designHighCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate) noexcept;
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept; //every stage, built from the three above at the oversampled rate
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate, int oversamplingFactor) noexcept; //the same at that factor, cramped or not
+bool isSameDesign(const ChainCoefficients& a, const ChainCoefficients& b) noexcept; //every stage, slope and factor equal, whatever the versions
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate) noexcept;
+double getChainMagnitudeForFrequency(const ChainCoefficients& coefficients, double frequency, double sampleRate) noexcept; //all active stages multiplied together, sampleRate before oversampling
+double getTailLengthInSamples(const ChainCoefficients& coefficients) noexcept; //how long the active stages take to ring down by 120 dB, at the rate before oversampling
+
+template<int Index, typename ChainType, typename CoefficientType>
+void update(ChainType& chain, const CoefficientType& coefficients)
+{
+    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]); //set the filter coefficient
+    chain.template setBypassed<Index>(false); // turn the filter back on
+}
+
+template<typename ChainType, typename CoefficientType>
+void updateCutFilter(ChainType& chain,
+    const CoefficientType& cutCoefficients,
+    int slope)
+{
+    chain.template setBypassed<0>(true); //bypass all four of the filters in the cut chain
+    chain.template setBypassed<1>(true);
+    chain.template setBypassed<2>(true);
+    chain.template setBypassed<3>(true);
+
+    switch (slope) //each steeper slope needs one more biquad, so the cases fall through
+    {
+    case Slope_48:
+        update<3>(chain, cutCoefficients);
+        [[fallthrough]];
+    case Slope_36:
+        update<2>(chain, cutCoefficients);
+        [[fallthrough]];
+    case Slope_24:
+        update<1>(chain, cutCoefficients);
+        [[fallthrough]];
+    case Slope_12:
+        update<0>(chain, cutCoefficients);
+    }
+}
+
+template<typename ChainType>
+void prepareAsBiquads(ChainType& cutChain)
+{
+    const juce::dsp::IIR::Coefficients<float> identity(1.f, 0.f, 0.f, 1.f, 0.f, 0.f); //passes audio straight through
+    *cutChain.template get<0>().coefficients = identity;
+    *cutChain.template get<1>().coefficients = identity;
+    *cutChain.template get<2>().coefficients = identity;
+    *cutChain.template get<3>().coefficients = identity;
+}
+
+template<typename SampleType>
+void prepareAsBiquads(juce::dsp::IIR::Filter<SampleType>& filter)
+{
+    *filter.coefficients = juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f, 1.f, 0.f, 0.f);
+}
+
+template<typename ChainType>
+void prepareChain(ChainType& chain, const juce::dsp::ProcessSpec& spec)
+{
+    //the filters size their state from the coefficient order, so every stage has to be a biquad before prepare()
+    //so the audio thread never reallocates it
+    prepareAsBiquads(chain.template get<ChainPosition::LowCut>());
+    prepareAsBiquads(chain.template get<ChainPosition::Peak>());
+    prepareAsBiquads(chain.template get<ChainPosition::HighCut>());
+    chain.prepare(spec);
+}
+
+template<typename ChainType>
+void applyCoefficients(ChainType& chain, const ChainCoefficients& coefficients) //works for the mono and the SIMD stereo channel groups alike
+{
+    updateBands(chain.template get<ChainPosition::Bands>(), coefficients.bands);
+    updateCutFilter(chain.template get<ChainPosition::LowCut>(), coefficients.lowCut, coefficients.lowCutSlope);
+    updateCutFilter(chain.template get<ChainPosition::HighCut>(), coefficients.highCut, coefficients.highCutSlope);
+}
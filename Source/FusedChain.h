@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    FusedChain.h
+
+    Alternative kernel for the whole LowCut / Bands / HighCut chain. Instead
+    of one pass over the block per stage, every active biquad runs on a
+    sample before moving on to the next one - one pass over memory. Up to
+    maxUnrolledStages the stage count is a compile time constant and all
+    coefficients and states are held in locals for the whole block; longer
+    chains run the same loops with a run time count.
+
+    The pipelined variant skews the stages across samples: in iteration i
+    stage k works on sample i - k, so the stages of one iteration don't depend
+    on each other and the CPU can overlap them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+#include "BandCascade.h"
+
+enum class ChainKernel
+{
+    processorChain, //one pass per stage through the juce::dsp::ProcessorChain
+    fused,          //all stages per sample
+    fusedPipelined  //all stages per sample, skewed across samples
+};
+
+template <typename SampleType, int NumStages, typename CoefficientArrays>
+struct FusedBiquads
+{
+    const CoefficientArrays& coefficients; //structure of arrays, stage k is at index k of each
+    SampleType s1[NumStages], s2[NumStages];
+
+    FusedBiquads(const CoefficientArrays& c, const SampleType* firstStates, const SampleType* secondStates) noexcept : coefficients(c)
+    {
+        for (int k = 0; k < NumStages; ++k)
+        {
+            s1[k] = firstStates[k];
+            s2[k] = secondStates[k];
+        }
+    }
+
+    void store(SampleType* firstStates, SampleType* secondStates) const noexcept
+    {
+        for (int k = 0; k < NumStages; ++k)
+        {
+            firstStates[k] = s1[k];
+            secondStates[k] = s2[k];
+        }
+    }
+
+    SampleType tick(int k, SampleType x) noexcept //one transposed direct form II step of stage k
+    {
+        const auto i = (size_t) k;
+        const auto y = x * coefficients.b0[i] + s1[k];
+        s1[k] = x * coefficients.b1[i] - y * coefficients.a1[i] + s2[k];
+        s2[k] = x * coefficients.b2[i] - y * coefficients.a2[i];
+        return y;
+    }
+};
+
+template <typename SampleType, int NumStages, typename StageList>
+void processFused(StageList& stages, SampleType* samples, size_t numSamples) noexcept
+{
+    FusedBiquads<SampleType, NumStages, std::decay_t<decltype(stages.getCoefficients())>> biquads(stages.getCoefficients(), stages.getFirstStates(), stages.getSecondStates());
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i];
+        for (int k = 0; k < NumStages; ++k) //constant trip count, fully unrolled
+            x = biquads.tick(k, x);
+        samples[i] = x;
+    }
+
+    biquads.store(stages.getFirstStates(), stages.getSecondStates());
+}
+
+template <typename SampleType, int NumStages, typename StageList>
+void processFusedPipelined(StageList& stages, SampleType* samples, size_t numSamples) noexcept
+{
+    FusedBiquads<SampleType, NumStages, std::decay_t<decltype(stages.getCoefficients())>> biquads(stages.getCoefficients(), stages.getFirstStates(), stages.getSecondStates());
+    SampleType carry[NumStages] {}; //carry[k] = what stage k - 1 produced last iteration, stage k's next input
+    const auto n = (std::ptrdiff_t) numSamples;
+
+    //iteration i runs stage k on sample i - k. Stages go from last to first so each one
+    //consumes its carry before the stage in front of it overwrites it.
+    auto iteration = [&](std::ptrdiff_t i, bool checkRange) noexcept
+    {
+        for (int k = NumStages - 1; k >= 0; --k)
+        {
+            const auto j = i - k;
+            if (checkRange && (j < 0 || j >= n)) //only while the pipeline fills and drains
+                continue;
+
+            const auto y = biquads.tick(k, k == 0 ? samples[j] : carry[k]);
+
+            if (k == NumStages - 1)
+                samples[j] = y; //sample j has already been read by stage 0, so writing in place is safe
+            else
+                carry[k + 1] = y;
+        }
+    };
+
+    const auto fill = (std::ptrdiff_t) NumStages - 1;
+    const auto numIterations = n + fill;
+
+    for (std::ptrdiff_t i = 0; i < juce::jmin(fill, numIterations); ++i)
+        iteration(i, true);
+
+    for (std::ptrdiff_t i = fill; i < n; ++i) //steady state, no range checks
+        iteration(i, false);
+
+    for (std::ptrdiff_t i = juce::jmax(fill, n); i < numIterations; ++i)
+        iteration(i, true);
+
+    biquads.store(stages.getFirstStates(), stages.getSecondStates());
+}
+
+//==============================================================================
+/** Holds the active stages of a chain back to back (low cut, bands, high cut) and runs them with a fused kernel. */
+template <typename SampleType>
+class FusedChain
+{
+public:
+    static constexpr int maxNumStages = 4 + maxNumBands + 4, maxUnrolledStages = 9;
+
+    void reset() noexcept { stages.reset(); }
+
+    void setCoefficients(const ChainCoefficients& coefficients) noexcept
+    {
+        //ids: low cut stages 0-3, bands 4.., high cut stages after the bands - a stage keeps its state as long as its id stays in
+        stages.beginUpdate();
+
+        for (int i = 0; i <= coefficients.lowCutSlope; ++i)
+            stages.add(i, coefficients.lowCut[(size_t) i]);
+
+        for (int band = 0; band < maxNumBands; ++band)
+            if (coefficients.isBandActive(band))
+                stages.add(4 + band, coefficients.bands.get(band));
+
+        for (int i = 0; i <= coefficients.highCutSlope; ++i)
+            stages.add(4 + maxNumBands + i, coefficients.highCut[(size_t) i]);
+    }
+
+    int getNumStages() const noexcept { return stages.getNumStages(); }
+    void setBiquadKernel(BiquadKernels::Function kernel) noexcept { stages.setKernel(kernel); } //for chains too long to unroll
+
+    void process(SampleType* samples, size_t numSamples, bool pipelined) noexcept
+    {
+        const auto numStages = getNumStages();
+        if (numStages == 0) //every stage is identity, the samples are already right
+            return;
+
+        if (numStages <= maxUnrolledStages)
+            (pipelined ? pipelinedFunctions : fusedFunctions)[numStages - 1](stages, samples, numSamples);
+        else if (pipelined)
+            stages.processSkewed(samples, numSamples);
+        else
+            stages.processFused(samples, numSamples);
+    }
+
+private:
+    using StageList = BiquadStageList<SampleType, maxNumStages>;
+    using ProcessFunction = void (*)(StageList&, SampleType*, size_t) noexcept;
+
+    static constexpr ProcessFunction fusedFunctions[maxUnrolledStages] = { &processFused<SampleType, 1, StageList>, &processFused<SampleType, 2, StageList>,
+                                                                           &processFused<SampleType, 3, StageList>, &processFused<SampleType, 4, StageList>,
+                                                                           &processFused<SampleType, 5, StageList>, &processFused<SampleType, 6, StageList>,
+                                                                           &processFused<SampleType, 7, StageList>, &processFused<SampleType, 8, StageList>,
+                                                                           &processFused<SampleType, 9, StageList> };
+    static constexpr ProcessFunction pipelinedFunctions[maxUnrolledStages] = { &processFusedPipelined<SampleType, 1, StageList>, &processFusedPipelined<SampleType, 2, StageList>,
+                                                                               &processFusedPipelined<SampleType, 3, StageList>, &processFusedPipelined<SampleType, 4, StageList>,
+                                                                               &processFusedPipelined<SampleType, 5, StageList>, &processFusedPipelined<SampleType, 6, StageList>,
+                                                                               &processFusedPipelined<SampleType, 7, StageList>, &processFusedPipelined<SampleType, 8, StageList>,
+                                                                               &processFusedPipelined<SampleType, 9, StageList> };
+
+    StageList stages;
+};
@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    LinearPhaseConvolver.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseConvolver.h"
+
+void LinearPhaseConvolver::prepare(double newSampleRate, int numChannels)
+{
+    sampleRate = newSampleRate;
+    firLength = (int) juce::nextPowerOfTwo(juce::roundToInt(sampleRate * firLengthSeconds));
+    partitionSize = firLength / numPartitions; //bigger FIRs get bigger partitions, never more of them
+    spectrumSize = (partitionSize + 1) * 2;
+
+    const auto partitionOrder = juce::findHighestSetBit((juce::uint32) partitionSize) + 1; //FFTs are twice the partition size
+    designFFT = std::make_unique<juce::dsp::FFT>(juce::findHighestSetBit((juce::uint32) firLength));
+    designPartitionFFT = std::make_unique<juce::dsp::FFT>(partitionOrder);
+    partitionFFT = std::make_unique<juce::dsp::FFT>(partitionOrder);
+
+    //real only transforms work in place on twice their size in floats
+    const auto frameSize = (size_t) partitionSize * 4;
+    const auto filterSize = (size_t) (numPartitions * spectrumSize);
+    designBuffer.assign((size_t) firLength * 2, 0.0f);
+    designFrame.assign(frameSize, 0.0f);
+    designs.forEachBuffer([filterSize](std::vector<float>& spectra) { spectra.assign(filterSize, 0.0f); });
+
+    channels.resize((size_t) numChannels);
+    for (auto& channel : channels)
+    {
+        channel.inputFifo.assign((size_t) partitionSize, 0.0f);
+        channel.previousInput.assign((size_t) partitionSize, 0.0f);
+        channel.outputFifo.assign((size_t) partitionSize, 0.0f);
+        channel.frame.assign(frameSize, 0.0f);
+        channel.history.assign(filterSize, 0.0f);
+    }
+
+    //until the first design arrives the FIR is a plain delay of getLatencySamples(), so the input comes through untouched
+    //and in time with what the host compensates for, then crossfades to the EQ like any other new design.
+    //The delay's impulse sits at firLength / 2, the start of the middle partition, whose spectrum is 1 in every bin.
+    filter.assign(filterSize, 0.0f);
+    for (int i = 0; i < spectrumSize; i += 2)
+        filter[(size_t) ((numPartitions / 2) * spectrumSize + i)] = 1.0f;
+
+    fadingFilter.assign(filterSize, 0.0f);
+    fadingFrame.assign(frameSize, 0.0f);
+    reset();
+}
+
+void LinearPhaseConvolver::reset() noexcept
+{
+    for (auto& channel : channels)
+    {
+        std::fill(channel.inputFifo.begin(), channel.inputFifo.end(), 0.0f);
+        std::fill(channel.previousInput.begin(), channel.previousInput.end(), 0.0f);
+        std::fill(channel.outputFifo.begin(), channel.outputFifo.end(), 0.0f);
+        std::fill(channel.history.begin(), channel.history.end(), 0.0f);
+    }
+
+    fifoPosition = 0;
+    historyHead = 0;
+    fading = false;
+}
+
+void LinearPhaseConvolver::design(const ChainCoefficients& coefficients)
+{
+    if (designFFT == nullptr)
+        return;
+
+    //zero phase spectrum straight from the IIR chain's magnitude response
+    auto* impulse = designBuffer.data();
+    std::fill(designBuffer.begin(), designBuffer.end(), 0.0f);
+    for (int bin = 0; bin <= firLength / 2; ++bin)
+        impulse[bin * 2] = (float) getChainMagnitudeForFrequency(coefficients, bin * sampleRate / firLength, sampleRate);
+
+    designFFT->performRealOnlyInverseTransform(impulse); //symmetric around sample 0, wrapped around the end
+
+    //moving the centre to firLength / 2 makes it causal, the window tames the truncation ripple
+    std::rotate(impulse, impulse + firLength / 2, impulse + firLength);
+    for (int i = 0; i < firLength; ++i)
+    {
+        const auto phase = juce::MathConstants<double>::twoPi * i / firLength;
+        impulse[i] *= (float) (0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase)); //Blackman
+    }
+
+    auto& spectra = designs.getWriteBuffer();
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        std::fill(designFrame.begin(), designFrame.end(), 0.0f);
+        std::copy(impulse + partition * partitionSize, impulse + (partition + 1) * partitionSize, designFrame.begin());
+        designPartitionFFT->performRealOnlyForwardTransform(designFrame.data(), true);
+        std::copy(designFrame.begin(), designFrame.begin() + spectrumSize, spectra.begin() + partition * spectrumSize);
+    }
+
+    designs.publish();
+}
+
+void LinearPhaseConvolver::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numChannels = juce::jmin(block.getNumChannels(), channels.size());
+    const auto numSamples = (int) block.getNumSamples();
+
+    for (int done = 0; done < numSamples;)
+    {
+        const auto todo = juce::jmin(numSamples - done, partitionSize - fifoPosition);
+
+        for (size_t i = 0; i < numChannels; ++i) //samples go in, the output computed one partition ago comes out
+        {
+            auto& channel = channels[i];
+            auto* samples = block.getChannelPointer(i) + done;
+            std::copy(samples, samples + todo, channel.inputFifo.begin() + fifoPosition);
+            std::copy(channel.outputFifo.begin() + fifoPosition, channel.outputFifo.begin() + fifoPosition + todo, samples);
+        }
+
+        fifoPosition += todo;
+        done += todo;
+
+        if (fifoPosition == partitionSize)
+        {
+            takeNewFilter(); //only ever switches on a partition boundary, the same one for every channel
+
+            for (size_t i = 0; i < numChannels; ++i)
+                processPartition(channels[i]);
+
+            fading = false;
+            historyHead = (historyHead + 1) % numPartitions;
+            fifoPosition = 0;
+        }
+    }
+}
+
+void LinearPhaseConvolver::takeNewFilter() noexcept
+{
+    if (! designs.acquire())
+        return;
+
+    std::swap(filter, fadingFilter); //keep the old FIR around for the crossfade
+    const auto& newest = designs.getReadBuffer();
+    std::copy(newest.begin(), newest.end(), filter.begin());
+    fading = true; //from the last design, or from the delay the very first time
+}
+
+void LinearPhaseConvolver::processPartition(Channel& channel) noexcept
+{
+    //overlap-save: transform the last two partitions of input, keep the second half of the result
+    auto* frame = channel.frame.data();
+    std::copy(channel.previousInput.begin(), channel.previousInput.end(), frame);
+    std::copy(channel.inputFifo.begin(), channel.inputFifo.end(), frame + partitionSize);
+    std::fill(frame + partitionSize * 2, frame + partitionSize * 4, 0.0f);
+    std::copy(channel.inputFifo.begin(), channel.inputFifo.end(), channel.previousInput.begin());
+
+    partitionFFT->performRealOnlyForwardTransform(frame, true);
+    std::copy(frame, frame + spectrumSize, channel.history.begin() + historyHead * spectrumSize);
+
+    multiplyAccumulate(channel, filter, frame);
+    partitionFFT->performRealOnlyInverseTransform(frame);
+    auto* output = channel.outputFifo.data();
+    std::copy(frame + partitionSize, frame + partitionSize * 2, output);
+
+    if (fading) //old and new FIR share the delay line, so the old one costs a second MAC and inverse FFT for just this partition
+    {
+        auto* old = fadingFrame.data();
+        multiplyAccumulate(channel, fadingFilter, old);
+        partitionFFT->performRealOnlyInverseTransform(old);
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const auto gain = (float) i / (float) partitionSize;
+            output[i] = old[partitionSize + i] + gain * (output[i] - old[partitionSize + i]);
+        }
+    }
+}
+
+void LinearPhaseConvolver::multiplyAccumulate(const Channel& channel, const std::vector<float>& spectra, float* result) const noexcept
+{
+    //sum over partitions of input spectrum (newest first) times filter partition, complex bins interleaved re/im
+    std::fill(result, result + partitionSize * 4, 0.0f);
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto* x = channel.history.data() + ((historyHead - partition + numPartitions) % numPartitions) * spectrumSize;
+        const auto* h = spectra.data() + partition * spectrumSize;
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            result[i]     += x[i] * h[i]     - x[i + 1] * h[i + 1];
+            result[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+}
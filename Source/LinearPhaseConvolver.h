@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    LinearPhaseConvolver.h
+
+    Linear phase version of the chain. The magnitude response of the current
+    ChainCoefficients is turned into a symmetric FIR on the design thread and
+    run here with a uniformly partitioned overlap-save FFT convolution.
+
+    The partition size grows with the FIR so there are always the same number
+    of partitions. Per sample that is one FFT pair of 2 * partition size plus a
+    fixed number of complex multiply-adds, so the cost stays flat as the FIR
+    gets longer at high sample rates, only the latency grows.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+#include "CoefficientService.h"
+
+class LinearPhaseConvolver
+{
+public:
+    static constexpr double firLengthSeconds = 0.1; //enough for the low cut to reach its full slope at 20 Hz
+    static constexpr int numPartitions = 16;
+
+    /** Allocates everything for the given rate, call from prepareToPlay while no design can run. */
+    void prepare(double sampleRate, int numChannels);
+    void reset() noexcept; //clears the delay lines, audio thread safe
+
+    int getFIRLength() const noexcept { return firLength; }
+    int getLatencySamples() const noexcept { return firLength / 2 + partitionSize; } //FIR group delay plus one partition of buffering
+    int getTailSamples() const noexcept { return firLength + partitionSize; }
+
+    /** Designs a new FIR from the chain's magnitude response and publishes it. Designing thread only. */
+    void design(const ChainCoefficients& coefficients);
+
+    /** Convolves up to the prepared number of channels in place. Crossfades over one partition when a new FIR arrives. */
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+private:
+    struct Channel
+    {
+        std::vector<float> inputFifo, previousInput, outputFifo, frame;
+        std::vector<float> history; //frequency domain delay line, the last numPartitions input spectra
+    };
+
+    void takeNewFilter() noexcept;
+    void processPartition(Channel& channel) noexcept;
+    void multiplyAccumulate(const Channel& channel, const std::vector<float>& spectra, float* result) const noexcept;
+
+    int firLength{ 0 }, partitionSize{ 0 }, spectrumSize{ 0 }; //spectrumSize in floats, (partitionSize + 1) interleaved complex bins
+    double sampleRate{ 0.0 };
+
+    //design side
+    std::unique_ptr<juce::dsp::FFT> designFFT, designPartitionFFT;
+    std::vector<float> designBuffer, designFrame;
+    TripleBuffer<std::vector<float>> designs; //numPartitions spectra back to back
+
+    //audio side
+    std::unique_ptr<juce::dsp::FFT> partitionFFT;
+    std::vector<Channel> channels;
+    std::vector<float> filter, fadingFilter, fadingFrame; //fadingFilter is the FIR we are leaving
+    bool fading{ false };
+    int fifoPosition{ 0 }, historyHead{ 0 };
+
+    JUCE_LEAK_DETECTOR (LinearPhaseConvolver)
+};
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.h
+
+    Parameter changes with a time stamp, for hosts that know where in the
+    audio their automation lands (the batch renderer reading an automation
+    file, say). processBlock cuts the block where the events fall instead of
+    reading every parameter once per block, so what comes out doesn't
+    depend on the host's buffer size.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ParameterEvent
+{
+    juce::int64 samplePosition{ 0 }; //counted from the start of the first block after prepareToPlay
+    int parameterIndex{ 0 }; //into AudioProcessor::getParameters()
+    float value{ 0.f }; //normalised, as AudioProcessorParameter::setValue takes it
+};
+
+/** Single producer / single consumer FIFO, neither side ever waits or allocates. Events go in in time order. */
+class ParameterEventQueue
+{
+public:
+    ParameterEventQueue() = default; //holds nothing until prepare(), every push() is refused
+
+    /** Makes room for capacity events and drops whatever is queued. Allocates, call while neither side is running. */
+    void prepare(int capacity)
+    {
+        if ((int) events.size() < capacity)
+            events.resize((size_t) capacity);
+        fifo.setTotalSize(capacity);
+    }
+
+    bool push(const ParameterEvent& event) noexcept //producer, false when the queue is full
+    {
+        if (fifo.getFreeSpace() < 1)
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        events[(size_t) (size1 > 0 ? start1 : start2)] = event;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    const ParameterEvent* peek() const noexcept //consumer, the oldest event still queued or nullptr
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+        return size1 + size2 > 0 ? &events[(size_t) (size1 > 0 ? start1 : start2)] : nullptr;
+    }
+
+    void pop() noexcept { fifo.finishedRead(1); } //consumer, after peek() returned an event
+
+    void clear() noexcept { fifo.finishedRead(fifo.getNumReady()); } //consumer side, drops whatever is queued
+
+private:
+    juce::AbstractFifo fifo{ 1 }; //one slot is always kept free, so this has room for nothing
+    std::vector<ParameterEvent> events;
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterEventQueue)
+};
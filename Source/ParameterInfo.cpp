@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    ParameterInfo.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterInfo.h"
+
+std::unique_ptr<juce::RangedAudioParameter> ParameterInfo::create() const
+{
+    switch (kind)
+    {
+    case choiceParameter:
+        return std::make_unique<juce::AudioParameterChoice>(id, id, choices, (int) defaultValue); //this makes a control like a dropdown of choices
+    case boolParameter:
+        return std::make_unique<juce::AudioParameterBool>(id, id, defaultValue > 0.5f);
+    default:
+        return std::make_unique<juce::AudioParameterFloat>(id, id, range, defaultValue);
+    }
+}
+
+namespace
+{
+    struct Tables
+    {
+        std::vector<ParameterInfo> parameters;
+        std::array<BandParameterIDs, maxNumBands> bandIDs;
+
+        Tables()
+        {
+            const juce::NormalisableRange<float> frequencyRange(20.f, 20000.f, 1.f, 0.25f); //low range of slider, high range, step size, pot taper
+            const juce::NormalisableRange<float> gainRange(-24.f, 24.f, 0.5f, 0.25f);
+            const juce::NormalisableRange<float> qualityRange(0.1f, 10.f, 0.05f, 0.25f);
+
+            juce::StringArray slopes;
+            for (int i = 0; i < 4; i++)
+            {
+                //for slope choice 0: 12 db/oct we need an order of 2 (1 coeff)
+                //for slope choice 1: 24 db/oct we need an order of 4 (2 coeff)
+                juce::String str;
+                str << (12 + (i * 12));
+                str << " db/Oct";
+                slopes.add(str);
+            }
+
+            for (int band = 0; band < maxNumBands; ++band)
+            {
+                auto& ids = bandIDs[(size_t) band];
+                ids.enabled = getBandParameterID(band, "Enabled");
+                ids.type = getBandParameterID(band, "Type");
+                ids.freq = getBandParameterID(band, "Freq");
+                ids.gain = getBandParameterID(band, "Gain");
+                ids.quality = getBandParameterID(band, "Quality");
+            }
+
+            addFloat("LowCut Freq", frequencyRange, 20.f, ParameterInfo::lowCutStage);
+            addFloat("HighCut Freq", frequencyRange, 20000.f, ParameterInfo::highCutStage);
+            addFloat(bandIDs[0].freq, frequencyRange, 750.f, 0);
+            addFloat(bandIDs[0].gain, gainRange, 0.f, 0);
+            addFloat(bandIDs[0].quality, qualityRange, 1.f, 0);
+            addChoice("LowCut Slope", slopes, 0, ParameterInfo::lowCutStage);
+            addChoice("HighCut Slope", slopes, 0, ParameterInfo::highCutStage);
+            addFloat("Smoothing Time", { 0.f, 500.f, 1.f, 0.5f }, 50.f); //ms to glide to new filter settings, 0 jumps straight there
+            addBool("Linear Phase", false); //same curve as an FIR, costs latency
+
+            //the first band is the original peak, its Freq / Gain / Quality are above so sessions and host automation keep their indices
+            const juce::StringArray bandTypes{ "Peak", "Low Shelf", "High Shelf", "Notch" };
+            for (int band = 0; band < maxNumBands; ++band)
+            {
+                const auto& ids = bandIDs[(size_t) band];
+                addBool(ids.enabled, band == 0, band);
+                addChoice(ids.type, bandTypes, Band_Peak, band);
+
+                if (band == 0)
+                    continue;
+
+                //spread the other bands' default frequencies evenly over the log range so enabling one lands somewhere useful
+                const auto defaultFreq = std::round(juce::mapToLog10((band - 0.5f) / (maxNumBands - 1), 20.f, 20000.f));
+                addFloat(ids.freq, frequencyRange, defaultFreq, band);
+                addFloat(ids.gain, gainRange, 0.f, band);
+                addFloat(ids.quality, qualityRange, 1.f, band);
+            }
+
+            //added after the bands so the existing parameters keep their indices. Same curve either way,
+            //the state variable filters take fast automation per sample where the biquads step every 32 samples
+            addChoice("Filter Topology", { "Biquad", "State Variable" }, 0);
+
+            //the Peak band's dynamic mode, "Peak " IDs so the editor shows them with the first band
+            addBool("Peak Dynamic", false);
+            addBool("Peak Sidechain", false); //keyed by the sidechain bus instead of the input
+            addFloat("Peak Threshold", { -60.f, 0.f, 0.5f }, -24.f);
+            addFloat("Peak Ratio", { 1.f, 20.f, 0.1f, 0.4f }, 4.f);
+            addFloat("Peak Attack", { 0.1f, 200.f, 0.1f, 0.3f }, 5.f); //ms
+            addFloat("Peak Release", { 5.f, 2000.f, 1.f, 0.3f }, 100.f); //ms
+
+            //the factor the IIR chain may run at, only while a band or cut sits in the top of the spectrum where the curves get squeezed
+            addChoice("Oversampling", { "Off", "2x", "4x", "8x" }, 0);
+        }
+
+        void addFloat(const juce::String& id, juce::NormalisableRange<float> range, float defaultValue, int stage = -1)
+        {
+            ParameterInfo info;
+            info.id = id;
+            info.range = range;
+            info.defaultValue = defaultValue;
+            info.stage = stage;
+            parameters.push_back(std::move(info));
+        }
+
+        void addChoice(const juce::String& id, const juce::StringArray& choices, int defaultIndex, int stage = -1)
+        {
+            ParameterInfo info;
+            info.id = id;
+            info.kind = ParameterInfo::choiceParameter;
+            info.choices = choices;
+            info.defaultValue = (float) defaultIndex;
+            info.stage = stage;
+            parameters.push_back(std::move(info));
+        }
+
+        void addBool(const juce::String& id, bool defaultValue, int stage = -1)
+        {
+            ParameterInfo info;
+            info.id = id;
+            info.kind = ParameterInfo::boolParameter;
+            info.defaultValue = defaultValue ? 1.f : 0.f;
+            info.stage = stage;
+            parameters.push_back(std::move(info));
+        }
+    };
+
+    const Tables& getTables()
+    {
+        static const Tables tables; //built by whichever instance comes first, C++ makes the others wait for it
+        return tables;
+    }
+}
+
+const std::vector<ParameterInfo>& getParameterInfos()
+{
+    return getTables().parameters;
+}
+
+const BandParameterIDs& getBandParameterIDs(int band)
+{
+    return getTables().bandIDs[(size_t) band];
+}
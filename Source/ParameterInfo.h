@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    ParameterInfo.h
+
+    Everything about the parameters that is the same in every instance:
+    IDs, ranges, defaults, choice lists, and which chain stage each one
+    designs. Built once per process, the first time an instance asks, and
+    only read after that. A new instance copies the IDs and choices out of
+    it, which for juce::String is a reference count rather than a new
+    string, so making the layout doesn't format or allocate any text.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+struct ParameterInfo
+{
+    enum Kind { floatParameter, choiceParameter, boolParameter };
+    static constexpr int lowCutStage = maxNumBands, highCutStage = maxNumBands + 1; //the stage numbering, the bands come first
+
+    juce::String id; //the name too
+    Kind kind{ floatParameter };
+    juce::NormalisableRange<float> range; //floats only
+    float defaultValue{ 0.f }; //the real world value, the item index for a choice, 0 or 1 for a bool
+    juce::StringArray choices;
+    int stage{ -1 }; //the chain stage it designs: a band's index, lowCutStage or highCutStage, -1 for none
+
+    std::unique_ptr<juce::RangedAudioParameter> create() const; //a parameter of this instance's own
+};
+
+/** Every parameter in the order getParameters() lists them, which sessions and host automation rely on. Thread safe. */
+const std::vector<ParameterInfo>& getParameterInfos();
+
+struct BandParameterIDs
+{
+    juce::String enabled, type, freq, gain, quality;
+};
+const BandParameterIDs& getBandParameterIDs(int band); //the same IDs getBandParameterID builds, built once
@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+//==============================================================================
+int LogHistogram::getBucket(juce::uint32 value) noexcept
+{
+    if (value < (juce::uint32) subBuckets) //the first octaves are exact
+        return (int) value;
+
+    const auto octave = juce::findHighestSetBit(value); //3 or more here
+    const auto subBucket = (int) (value >> (octave - 3)) & (subBuckets - 1);
+    return (octave - 2) * subBuckets + subBucket;
+}
+
+juce::uint32 LogHistogram::getBucketUpperEdge(int bucket) noexcept
+{
+    if (bucket < subBuckets)
+        return (juce::uint32) bucket;
+
+    const auto shift = bucket / subBuckets - 1;
+    const auto lower = (juce::uint64) (subBuckets + bucket % subBuckets) << shift;
+    return (juce::uint32) juce::jmin((juce::uint64) std::numeric_limits<juce::uint32>::max(), lower + ((juce::uint64) 1 << shift) - 1);
+}
+
+void LogHistogram::add(juce::uint32 value) noexcept
+{
+    //single writer, so plain load + store is enough and cheaper than a read-modify-write
+    auto& bucket = buckets[(size_t) getBucket(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (value > maximum.load(std::memory_order_relaxed))
+        maximum.store(value, std::memory_order_relaxed);
+}
+
+void LogHistogram::reset() noexcept
+{
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+
+    count.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+juce::uint32 LogHistogram::getPercentile(double proportion) const noexcept
+{
+    juce::uint64 total = 0; //counted from the buckets so it matches them even while the writer is running
+    for (auto& bucket : buckets)
+        total += bucket.load(std::memory_order_relaxed);
+
+    if (total == 0)
+        return 0;
+
+    const auto target = juce::jmax((juce::uint64) 1, (juce::uint64) std::ceil(proportion * (double) total));
+    juce::uint64 seen = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += buckets[(size_t) i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return juce::jmin(getBucketUpperEdge(i), getMax());
+    }
+
+    return getMax();
+}
+
+//==============================================================================
+const char* PerformanceMonitor::getSectionName(Section section) noexcept
+{
+    switch (section)
+    {
+        case parameterRead:     return "parameterRead";
+        case coefficientUpdate: return "coefficientUpdate";
+        case processing:        return "processing";
+        case numSections:       break;
+    }
+
+    return "";
+}
+
+void PerformanceMonitor::enableTracing(int maxCallbacks)
+{
+    trace.assign((size_t) juce::jmax(0, maxCallbacks), {});
+    traceWritten = 0;
+}
+
+static juce::uint32 ticksToNanoseconds(juce::int64 ticks) noexcept
+{
+    const auto nanoseconds = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9;
+    return (juce::uint32) juce::jlimit(0.0, (double) std::numeric_limits<juce::uint32>::max(), nanoseconds);
+}
+
+void PerformanceMonitor::record(juce::int64 startTicks, const juce::int64* sectionTicks, juce::int64 totalTicks, double budgetSeconds) noexcept
+{
+    TraceEvent event;
+    event.startTicks = startTicks;
+    event.totalNanoseconds = ticksToNanoseconds(totalTicks);
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        event.nanoseconds[i] = ticksToNanoseconds(sectionTicks[i]);
+        sections[i].add(event.nanoseconds[i]);
+    }
+
+    callbacks.add(event.totalNanoseconds);
+
+    if (budgetSeconds > 0.0)
+    {
+        const auto load = event.totalNanoseconds * 1.0e-9 / budgetSeconds;
+        event.load = (float) load;
+        loads.add((juce::uint32) juce::jmin(load * 1.0e6, (double) std::numeric_limits<juce::uint32>::max()));
+
+        if (load > spikeThreshold.load(std::memory_order_relaxed))
+            spikes.store(spikes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    if (! trace.empty())
+    {
+        const auto written = traceWritten.load(std::memory_order_relaxed);
+        trace[(size_t) (written % trace.size())] = event;
+        traceWritten.store(written + 1, std::memory_order_release);
+    }
+}
+
+static PerformanceMonitor::Statistics makeStatistics(const LogHistogram& histogram, double scale) noexcept
+{
+    PerformanceMonitor::Statistics statistics;
+    statistics.p50 = histogram.getPercentile(0.5) * scale;
+    statistics.p99 = histogram.getPercentile(0.99) * scale;
+    statistics.max = histogram.getMax() * scale;
+    statistics.count = histogram.getCount();
+    return statistics;
+}
+
+PerformanceMonitor::Statistics PerformanceMonitor::getSectionStatistics(Section section) const noexcept
+{
+    return makeStatistics(sections[section], 1.0e-3);
+}
+
+PerformanceMonitor::Statistics PerformanceMonitor::getCallbackStatistics() const noexcept
+{
+    return makeStatistics(callbacks, 1.0e-3);
+}
+
+PerformanceMonitor::Statistics PerformanceMonitor::getLoadStatistics() const noexcept
+{
+    return makeStatistics(loads, 1.0e-6);
+}
+
+void PerformanceMonitor::reset() noexcept
+{
+    for (auto& section : sections)
+        section.reset();
+
+    callbacks.reset();
+    loads.reset();
+    spikes = 0;
+}
+
+juce::Array<juce::var> PerformanceMonitor::getChromeTraceEvents(int threadId, juce::int64 originTicks) const
+{
+    juce::Array<juce::var> events;
+    const auto written = traceWritten.load(std::memory_order_acquire);
+    const auto numEvents = juce::jmin(written, (juce::uint64) trace.size());
+    const auto threshold = spikeThreshold.load();
+
+    auto addEvent = [&events, threadId](const juce::String& name, const char* phase, double timestamp, double duration)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("name", name);
+        object->setProperty("cat", "audio");
+        object->setProperty("ph", phase);
+        object->setProperty("ts", timestamp);
+        object->setProperty("pid", 1);
+        object->setProperty("tid", threadId);
+        if (duration >= 0.0)
+            object->setProperty("dur", duration);
+        events.add(juce::var(object));
+        return object;
+    };
+
+    for (auto i = written - numEvents; i < written; ++i) //oldest first
+    {
+        const auto& event = trace[(size_t) (i % trace.size())];
+        auto timestamp = juce::Time::highResolutionTicksToSeconds(event.startTicks - originTicks) * 1.0e6; //microseconds
+
+        auto* args = new juce::DynamicObject();
+        args->setProperty("load", event.load);
+        addEvent("processBlock", "X", timestamp, event.totalNanoseconds * 1.0e-3)->setProperty("args", juce::var(args));
+
+        //sections can interleave (coefficient updates between sub-blocks), each is shown as one slice of its summed time
+        for (int section = 0; section < numSections; ++section)
+        {
+            const auto duration = event.nanoseconds[section] * 1.0e-3;
+            addEvent(getSectionName((Section) section), "X", timestamp, duration);
+            timestamp += duration;
+        }
+
+        if (event.load > threshold)
+            addEvent("spike", "i", juce::Time::highResolutionTicksToSeconds(event.startTicks - originTicks) * 1.0e6, -1.0)
+                ->setProperty("s", "t");
+    }
+
+    return events;
+}
+
+//==============================================================================
+PerformanceMonitor::ScopedCallback::ScopedCallback(PerformanceMonitor& m, int numSamples, double sampleRate) noexcept
+    : monitor(m), active(m.isEnabled())
+{
+    if (! active)
+        return;
+
+    budgetSeconds = sampleRate > 0.0 ? numSamples / sampleRate : 0.0;
+    startTicks = lastTicks = juce::Time::getHighResolutionTicks();
+}
+
+PerformanceMonitor::ScopedCallback::~ScopedCallback()
+{
+    if (! active)
+        return;
+
+    const auto now = juce::Time::getHighResolutionTicks();
+    ticks[current] += now - lastTicks;
+    monitor.record(startTicks, ticks, now - startTicks, budgetSeconds);
+}
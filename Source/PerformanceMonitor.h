@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+
+    Always-on timing of processBlock. Each callback is split into sections
+    (parameter reads, coefficient updates, the chain itself) and every
+    section's time goes into a lock-free log-scale histogram, alongside the
+    callback's share of its real-time budget. Callbacks that use more of the
+    budget than the spike threshold are counted, and when tracing is switched
+    on every callback is also kept for a Chrome / Perfetto trace.
+
+    The audio thread is the only writer. Disabled, a callback costs one
+    relaxed atomic load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Counts values in buckets that are 1/8 of an octave wide, so percentiles come out within about 12%. Single writer. */
+class LogHistogram
+{
+public:
+    void add(juce::uint32 value) noexcept;
+    void reset() noexcept;
+
+    juce::uint64 getCount() const noexcept { return count.load(std::memory_order_relaxed); }
+    juce::uint32 getMax() const noexcept { return maximum.load(std::memory_order_relaxed); }
+    juce::uint32 getPercentile(double proportion) const noexcept; //upper edge of the bucket the percentile falls in
+
+private:
+    static constexpr int subBuckets = 8, numBuckets = 30 * subBuckets;
+    static int getBucket(juce::uint32 value) noexcept;
+    static juce::uint32 getBucketUpperEdge(int bucket) noexcept;
+
+    std::array<std::atomic<juce::uint32>, numBuckets> buckets{};
+    std::atomic<juce::uint64> count{ 0 };
+    std::atomic<juce::uint32> maximum{ 0 };
+};
+
+class PerformanceMonitor
+{
+public:
+    enum Section
+    {
+        parameterRead,
+        coefficientUpdate,
+        processing,
+        numSections
+    };
+
+    static const char* getSectionName(Section section) noexcept;
+
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled = shouldBeEnabled; }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    /** Callbacks using more than this share of their budget count as spikes. */
+    void setSpikeThreshold(double proportionOfBudget) noexcept { spikeThreshold = proportionOfBudget; }
+    double getSpikeThreshold() const noexcept { return spikeThreshold.load(); }
+
+    /** Keeps the last maxCallbacks callbacks for getChromeTraceEvents(). Allocates, so not while processing. */
+    void enableTracing(int maxCallbacks);
+
+    struct Statistics
+    {
+        double p50{ 0.0 }, p99{ 0.0 }, max{ 0.0 }; //microseconds, or proportion of the budget for the load
+        juce::uint64 count{ 0 };
+    };
+
+    Statistics getSectionStatistics(Section section) const noexcept;
+    Statistics getCallbackStatistics() const noexcept;
+    Statistics getLoadStatistics() const noexcept;
+    juce::uint64 getNumSpikes() const noexcept { return spikes.load(std::memory_order_relaxed); }
+    void reset() noexcept; //the counts may be off by a callback if the audio thread is running
+
+    /** Chrome trace "complete" events for the traced callbacks, timestamps relative to originTicks. */
+    juce::Array<juce::var> getChromeTraceEvents(int threadId, juce::int64 originTicks) const;
+
+    /** Put one at the top of processBlock and call enter() whenever the work moves to another section. */
+    class ScopedCallback
+    {
+    public:
+        ScopedCallback(PerformanceMonitor& monitor, int numSamples, double sampleRate) noexcept;
+        ~ScopedCallback();
+
+        void enter(Section next) noexcept
+        {
+            if (! active)
+                return;
+
+            const auto now = juce::Time::getHighResolutionTicks();
+            ticks[current] += now - lastTicks;
+            lastTicks = now;
+            current = next;
+        }
+
+    private:
+        PerformanceMonitor& monitor;
+        const bool active;
+        double budgetSeconds{ 0.0 };
+        juce::int64 startTicks{ 0 }, lastTicks{ 0 };
+        juce::int64 ticks[numSections]{};
+        int current{ parameterRead };
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCallback)
+    };
+
+private:
+    struct TraceEvent
+    {
+        juce::int64 startTicks{ 0 };
+        juce::uint32 nanoseconds[numSections]{}, totalNanoseconds{ 0 };
+        float load{ 0.0f };
+    };
+
+    void record(juce::int64 startTicks, const juce::int64* sectionTicks, juce::int64 totalTicks, double budgetSeconds) noexcept;
+
+    std::atomic<bool> enabled{ true };
+    std::atomic<double> spikeThreshold{ 0.5 };
+    LogHistogram sections[numSections], callbacks, loads; //nanoseconds, nanoseconds, parts per million of the budget
+    std::atomic<juce::uint64> spikes{ 0 };
+
+    std::vector<TraceEvent> trace; //ring, sized by enableTracing
+    std::atomic<juce::uint64> traceWritten{ 0 };
+};
@@ -11,15 +11,121 @@
 
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p),
+      analyzer (p.getPreEQFifo(), p.getPostEQFifo())
 {
+    for (int band = 0; band < maxNumBands; ++band)
+        bandSelector.addItem("Band " + juce::String(band + 1), band + 1);
+    bandSelector.onChange = [this] { showSelectedBand(); };
+    addAndMakeVisible(bandSelector);
+
+    addParameterControls();
+    bandSelector.setSelectedId(1, juce::dontSendNotification);
+    showSelectedBand(); //hides every other band's controls
+    audioProcessor.setAnalyzerEnabled(true); //allocates the FIFOs, so it has to come before the analyzer's thread reads them
+    analyzer.start();
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setResizable(true, true);
+    setResizeLimits(400, 350, 1600, 1200);
+    setSize (640, 520);
+
+    startTimerHz(SpectrumAnalyzer::framesPerSecond);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
+    audioProcessor.setAnalyzerEnabled(false); //processBlock stops copying samples as soon as nobody is looking
+}
+
+void SimpleEQAudioProcessorEditor::addParameterControls()
+{
+    for (auto* parameter : audioProcessor.getParameters())
+    {
+        auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter);
+        controlBands.add(withID != nullptr ? getBandOfParameter(withID->paramID) : -1);
+        labels.add(nullptr);
+        controls.add(nullptr);
+
+        if (withID != nullptr && controlBands.getLast() < 0) //the bands' controls wait until the band is shown
+            createControl(parameter->getParameterIndex());
+    }
+}
+
+void SimpleEQAudioProcessorEditor::createControl(int parameterIndex)
+{
+    auto* parameter = audioProcessor.getParameters()[parameterIndex];
+    auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter);
+    if (withID == nullptr || controls[parameterIndex] != nullptr)
+        return;
+
+    auto* label = labels.set(parameterIndex, new juce::Label({}, withID->getName(32)));
+    label->setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(label);
+
+    juce::Component* control = nullptr;
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(parameter))
+    {
+        auto* box = new juce::ComboBox();
+        box->addItemList(choice->choices, 1); //the items have to be there before the attachment syncs them
+        control = box;
+        comboBoxAttachments.add(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(audioProcessor.apvts, withID->paramID, *box));
+    }
+    else if (dynamic_cast<juce::AudioParameterBool*>(parameter) != nullptr)
+    {
+        auto* button = new juce::ToggleButton();
+        control = button;
+        buttonAttachments.add(new juce::AudioProcessorValueTreeState::ButtonAttachment(audioProcessor.apvts, withID->paramID, *button));
+    }
+    else
+    {
+        auto* slider = new juce::Slider(juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::TextBoxBelow);
+        control = slider;
+        sliderAttachments.add(new juce::AudioProcessorValueTreeState::SliderAttachment(audioProcessor.apvts, withID->paramID, *slider));
+    }
+
+    controls.set(parameterIndex, control);
+    addAndMakeVisible(control);
+}
+
+void SimpleEQAudioProcessorEditor::showSelectedBand()
+{
+    const auto selectedBand = bandSelector.getSelectedId() - 1;
+    for (int i = 0; i < controls.size(); ++i)
+    {
+        const auto visible = controlBands[i] < 0 || controlBands[i] == selectedBand;
+        if (visible)
+            createControl(i);
+
+        if (controls[i] != nullptr)
+        {
+            labels[i]->setVisible(visible);
+            controls[i]->setVisible(visible);
+        }
+    }
+
+    resized();
+}
+
+void SimpleEQAudioProcessorEditor::refreshControls()
+{
+    //dontSendNotification keeps the attachments quiet, so nothing goes back to the parameter or the host
+    const auto& parameters = audioProcessor.getParameters();
+    for (int i = 0; i < controls.size(); ++i)
+    {
+        auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(parameters[i]);
+        if (controls[i] == nullptr || parameter == nullptr)
+            continue;
+
+        const auto value = parameter->convertFrom0to1(parameter->getValue());
+        if (auto* slider = dynamic_cast<juce::Slider*>(controls[i]))
+            slider->setValue(value, juce::dontSendNotification);
+        else if (auto* box = dynamic_cast<juce::ComboBox*>(controls[i]))
+            box->setSelectedItemIndex(juce::roundToInt(value), juce::dontSendNotification);
+        else if (auto* button = dynamic_cast<juce::Button*>(controls[i]))
+            button->setToggleState(value > 0.5f, juce::dontSendNotification);
+    }
 }
 
 //==============================================================================
@@ -28,13 +134,106 @@ void SimpleEQAudioProcessorEditor::paint (juce::Graphics& g)
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
 
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+    g.setColour(juce::Colours::black);
+    g.fillRect(analyzerArea);
+
+    //frequency grid, decades and the 2/5 in between
+    g.setColour(juce::Colours::dimgrey);
+    for (auto frequency : { 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0 })
+    {
+        const auto x = analyzerArea.getX() + analyzerArea.getWidth() * (float) juce::mapFromLog10(frequency, 20.0, 20000.0);
+        g.drawVerticalLine(juce::roundToInt(x), (float) analyzerArea.getY(), (float) analyzerArea.getBottom());
+    }
+
+    g.setColour(juce::Colours::grey.withAlpha(0.8f));
+    g.strokePath(preEQPath, juce::PathStrokeType(1.0f));
+    g.setColour(juce::Colours::orange);
+    g.strokePath(postEQPath, juce::PathStrokeType(1.5f));
+
+    if (isResponseCurveStale())
+        responseCurve.update(audioProcessor.getCoefficientService().getLatestCoefficients(), analyzerArea.toFloat(), audioProcessor.getSampleRate());
+
+    g.setColour(juce::Colours::white);
+    g.strokePath(responseCurve.getPath(), juce::PathStrokeType(2.0f));
+
+    g.setFont (12.0f);
+    g.drawFittedText(countersText, countersArea, juce::Justification::centredLeft, 2);
 }
 
 void SimpleEQAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
+    auto bounds = getLocalBounds().reduced(8);
+    analyzerArea = bounds.removeFromTop(juce::roundToInt(bounds.getHeight() * 0.5f));
+    countersArea = bounds.removeFromTop(32);
+    analyzer.setBounds(analyzerArea.toFloat()); //the old paths are stretched until the thread has built new ones
+    bandSelector.setBounds(bounds.removeFromTop(24).removeFromLeft(120));
+
+    int numVisible = 0;
+    for (auto* control : controls)
+        numVisible += control != nullptr && control->isVisible() ? 1 : 0;
+
+    constexpr int columns = 4;
+    const auto rows = juce::jmax(1, (numVisible + columns - 1) / columns);
+    const auto cellWidth = bounds.getWidth() / columns;
+    const auto cellHeight = bounds.getHeight() / rows;
+
+    for (int i = 0, cellIndex = 0; i < controls.size(); ++i)
+    {
+        if (controls[i] == nullptr || ! controls[i]->isVisible())
+            continue;
+
+        auto cell = juce::Rectangle<int>(bounds.getX() + (cellIndex % columns) * cellWidth, bounds.getY() + (cellIndex / columns) * cellHeight, cellWidth, cellHeight).reduced(4);
+        labels[i]->setBounds(cell.removeFromTop(18));
+        controls[i]->setBounds(cell);
+        ++cellIndex;
+    }
+}
+
+bool SimpleEQAudioProcessorEditor::isResponseCurveStale() const noexcept
+{
+    const auto sampleRate = audioProcessor.getSampleRate();
+    return sampleRate > 0.0 //nothing designed before the first prepareToPlay
+        && responseCurve.isStale(audioProcessor.getCoefficientService().getLatestVersion(), analyzerArea.toFloat(), sampleRate);
+}
+
+void SimpleEQAudioProcessorEditor::timerCallback()
+{
+    if (const auto count = audioProcessor.getAppliedEventCount(); count != lastAppliedEventCount)
+    {
+        lastAppliedEventCount = count;
+        refreshControls();
+    }
+
+    analyzer.setSampleRate(audioProcessor.getSampleRate());
+
+    if (analyzer.getPaths(preEQPath, postEQPath) || isResponseCurveStale())
+        repaint(analyzerArea);
+
+    if (++timerTicks % SpectrumAnalyzer::framesPerSecond == 0) //the counters once a second is plenty
+    {
+        auto& counters = audioProcessor.getRealtimeCounters();
+        countersText = "callbacks: " + juce::String(counters.callbacks.load())
+                     + "   allocations in callback: " + (RealtimeCounters::isCountingAllocations() ? juce::String(counters.allocations.load()) : juce::String("not counted"))
+                     + "   worst callback: " + juce::String(counters.worstCallbackLoad.load() * 100.0, 1) + "% of block"
+                     + "   analyzer drops: " + juce::String(audioProcessor.getPostEQFifo().getNumDroppedSamples());
+
+        auto& monitor = audioProcessor.getPerformanceMonitor();
+        if (monitor.isEnabled())
+        {
+            const auto callback = monitor.getCallbackStatistics();
+            const auto load = monitor.getLoadStatistics();
+            countersText << "\nprocessBlock p50 " << juce::String(callback.p50, 1) << " us, p99 " << juce::String(callback.p99, 1)
+                         << " us, max " << juce::String(callback.max, 1) << " us   load p99 " << juce::String(load.p99 * 100.0, 1)
+                         << "%   spikes over " << juce::String(monitor.getSpikeThreshold() * 100.0, 0) << "%: " << juce::String((juce::int64) monitor.getNumSpikes());
+
+            for (int i = 0; i < PerformanceMonitor::numSections; ++i)
+            {
+                const auto section = (PerformanceMonitor::Section) i;
+                countersText << "   " << PerformanceMonitor::getSectionName(section) << " p99 " << juce::String(monitor.getSectionStatistics(section).p99, 1) << " us";
+            }
+        }
+        repaint(countersArea);
+    }
 }
@@ -10,11 +10,15 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumAnalyzer.h"
+#include "ResponseCurve.h"
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+//pre/post EQ spectrum on top, one control per parameter underneath
+class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      private juce::Timer
 {
 public:
     SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor&);
@@ -25,9 +29,34 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+    void addParameterControls();
+    void createControl(int parameterIndex);
+    void showSelectedBand();
+    void refreshControls(); //reads every control's value back from its parameter, without telling the parameter
+    bool isResponseCurveStale() const noexcept;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SimpleEQAudioProcessor& audioProcessor;
 
+    SpectrumAnalyzer analyzer; //owns the analysis thread, only runs while the editor is open
+    juce::Path preEQPath, postEQPath;
+    ResponseCurve responseCurve; //only rebuilt when a new design comes out or the editor changes size
+    juce::Rectangle<int> analyzerArea, countersArea;
+    juce::String countersText;
+    int timerTicks{ 0 };
+    juce::uint32 lastAppliedEventCount{ 0 }; //queued automation doesn't notify the attachments, the timer looks for it
+
+    //controls are made from the parameter list so new parameters show up without touching the editor.
+    //A band's only get made the first time it's selected, most of the 32 never are
+    juce::OwnedArray<juce::Label> labels; //one slot per parameter, nullptr until its control is made
+    juce::OwnedArray<juce::Component> controls;
+    juce::Array<int> controlBands; //which band each control belongs to, -1 for the rest. Only the selected band's are shown
+    juce::ComboBox bandSelector;
+    juce::OwnedArray<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachments; //after the controls so they go first
+    juce::OwnedArray<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachments;
+    juce::OwnedArray<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachments;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessorEditor)
 };
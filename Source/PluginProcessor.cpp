@@ -18,14 +18,36 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false) //keys the Peak band's dynamic mode, off unless the host connects it
+                      #endif
                      #endif
                        )
 #endif
 {
+    smoothingTime = apvts.getRawParameterValue("Smoothing Time");
+    linearPhaseMode = apvts.getRawParameterValue("Linear Phase");
+    filterTopology = apvts.getRawParameterValue("Filter Topology");
+    oversamplingMode = apvts.getRawParameterValue("Oversampling");
+
+    //which chain stages each parameter designs, so a queued change only redesigns those
+    const auto& infos = getParameterInfos();
+    jassert(getParameters().size() == (int) infos.size()); //everything comes from the shared layout, in the same order
+    eventTargets.reserve(infos.size());
+    for (auto* parameter : getParameters())
+    {
+        const auto& info = infos[(size_t) parameter->getParameterIndex()];
+        eventTargets.push_back({ static_cast<juce::RangedAudioParameter*>(parameter), apvts.getRawParameterValue(info.id),
+                                 info.stage >= 0 ? getStageBit(info.stage) : 0 });
+    }
+    coefficientService.setListener(this);
+    loadPresetBank(PresetBank::getDefaultFile());
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    coefficientService.setListener(nullptr); //waits for a listener call in flight, the convolver goes before the service does
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -63,27 +85,75 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const auto sampleRate = getSampleRate();
+    if (sampleRate <= 0.0)
+        return 0.0;
+
+    if (isLinearPhase())
+        return linearPhase.getTailSamples() / sampleRate; //the FIR keeps ringing for its full length plus the partition delay
+
+    //until the slowest poles have died away, and the resampling has let the last of them out
+    return juce::jmin((designedTailSamples.load() + oversampler.getLatencySamples(getRequestedOversampling())) / sampleRate, maxTailSeconds);
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
 {
+    if (presetBank != nullptr)
+        return presetBank->getNumPresets();
+
     return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
                 // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentPreset;
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram (int index)
 {
+    if (presetBank == nullptr || ! juce::isPositiveAndBelow(index, presetBank->getNumPresets()))
+        return;
+
+    currentPreset = index;
+
+    //the bank already holds the design for the common rates, so the switch is just a publish and the smoother's glide
+    ChainCoefficients designed;
+    const auto hasDesign = presetBank->getCoefficients(index, getSampleRate(), designed);
+    coefficientService.applyPredesigned(hasDesign ? &designed : nullptr, getSampleRate(), [this, index]
+    {
+        ++recallCount;
+        presetBank->applyValues(index, apvts);
+        ++recallCount;
+    });
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank != nullptr ? presetBank->getName(index) : juce::String();
+}
+
+bool SimpleEQAudioProcessor::loadPresetBank (const juce::File& file)
+{
+    auto bank = PresetBank::open(file);
+    if (bank == nullptr)
+        return false;
+
+    presetBank = std::move(bank); //nothing on the audio thread points into the bank, designs are copied out of it
+    currentPreset = 0;
+    updateHostDisplay(ChangeDetails().withProgramChanged(true));
+    return true;
+}
+
+void SimpleEQAudioProcessor::setAnalyzerEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled) //before the flag, processBlock only pushes once it sees it
+    {
+        preEQFifo.allocate();
+        postEQFifo.allocate();
+    }
+
+    analyzerEnabled = shouldBeEnabled;
 }
 
 void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -95,20 +165,101 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    juce::dsp::ProcessSpec spec; //prepares the filters before using them - spec gets passed to each link in the chain
-    spec.maximumBlockSize = samplesPerBlock; //max # of amples to process at once
+    auto& spec = preparedSpec; //prepares the filters before using them - spec gets passed to each link in the chain, kept for the oversampled path
+    spec.maximumBlockSize = (juce::uint32) samplesPerBlock; //max # of amples to process at once, at the base rate
     spec.numChannels = 1; //for mono
     spec.sampleRate = sampleRate;
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    auto chainSettings = getChainSettings(apvts); //makes the filter with the values from our interface
-    updatePeakFilter(chainSettings);
+    const auto numChannels = preparedNumChannels = juce::jmax(1, getTotalNumOutputChannels());
+    const auto numGroups = (numChannels + (int) SIMDChannelGroup::laneCount - 1) / (int) SIMDChannelGroup::laneCount;
+
+    //the widest instruction set this CPU has that passed the self-test, unless an override asks for another
+    kernelIsa = BiquadKernels::getSelected();
+
+    preparePath(paths[0], 1);
+    paths[0].factor = 1;
+    paths[0].isRunning = true;
+
+    //the oversampled path's groups are only made once a factor is asked for, prepareOversampling() does it below or later
+    paths[1].monoChain.clear();
+    paths[1].channelGroups.clear();
+    paths[1].factor = 1; //picks up the Oversampling choice in the first block
+    paths[1].isRunning = false;
+    oversampledPathPrepared = false;
+    activePath = wantedPath = 0;
+    primedSamples = fadedSamples = 0;
+    dynamicPeak.prepare(sampleRate, numChannels);
+
+    //the audio thread always takes a share of the work itself, so a layout needs at least two groups to be worth splitting
+    if (numChannels >= parallelChannelThreshold && numGroups > 1 && juce::SystemStats::getNumCpus() > 1)
+    {
+        if (! workerPool.has_value())
+            workerPool.emplace(); //starts the shared workers if this is the first instance to want them
+    }
+    else
+    {
+        workerPool.reset();
+    }
+    blockPeriodSeconds = samplesPerBlock / sampleRate;
+
+    coefficientService.setListener(nullptr); //the FIR can't be designed while the convolver is reallocated
+    linearPhase.prepare(sampleRate, numChannels);
+    linearPhaseActive = false;
+    oversampler.prepare(numChannels, samplesPerBlock); //drops every factor, the design thread reads their latencies
+    if (isNonRealtime()) //offline hosts may never run the message loop that allocates a factor later, so they get them all now
+        for (int factor = 2; factor <= maxOversamplingFactor; factor *= 2)
+            prepareOversampling(factor);
+    else
+        prepareOversampling(getRequestedOversampling());
+    coefficientService.setListener(this);
+
+    parameterEvents.prepare(maxQueuedEvents); //positions count from the next block, anything queued before is dropped
+    samplePosition = 0;
+    eventStages = 0;
+    eventChanges = 0;
+    svfActive = false;
+    silentSamples = 0;
+    isIdle = false;
+    coefficientService.prepare(sampleRate); //makes the filters with the values from our interface
+    updateLatency();
 }//updating 
 
+void SimpleEQAudioProcessor::preparePath (IirPath& path, int factor)
+{
+    auto spec = preparedSpec;
+    spec.maximumBlockSize *= (juce::uint32) factor; //the chain sees that many more samples per block
+    const auto numGroups = (preparedNumChannels + (int) SIMDChannelGroup::laneCount - 1) / (int) SIMDChannelGroup::laneCount;
+    const auto biquadKernel = BiquadKernels::get(kernelIsa);
+
+    path.monoChain.prepare(preparedNumChannels == 1 ? 1 : 0, spec); //nothing held for the layouts that never use it
+    path.monoChain.forEach([biquadKernel](ScalarChannelGroup& chain) { chain.setBiquadKernel(biquadKernel); });
+    path.svfChain.prepare(spec.sampleRate, preparedNumChannels);
+    path.channelGroups.prepare(numGroups, spec); //all the groups in one block, reused when the layout doesn't grow
+    path.channelGroups.forEach([biquadKernel](SIMDChannelGroup& group) { group.setBiquadKernel(biquadKernel); });
+    path.smoother.reset(); //the first design after a prepare is loaded straight away
+}
+
+void SimpleEQAudioProcessor::prepareOversampling (int factor)
+{
+    //a factor only once it's asked for, so an instance left Off never holds any of it
+    if (factor <= 1 || oversampler.isAllocated(factor) || preparedSpec.sampleRate <= 0.0)
+        return;
+
+    //the audio thread leaves the oversampled path alone until a factor is allocated, so it can be built while playing.
+    //Sized for the highest factor once, a later choice only adds its resampling
+    if (! oversampledPathPrepared)
+    {
+        preparePath(paths[1], maxOversamplingFactor);
+        oversampledPathPrepared = true;
+    }
+
+    oversampler.allocate(factor); //publishes the lot to the audio thread
+}
+
 void SimpleEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    workerPool.reset(); //the last instance to let go stops the shared workers, no point keeping threads around while we're not playing
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -118,18 +269,21 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel runs the same chain, so any layout from mono up to
+    // maxNumChannels works - stereo, 7.1.4, ambisonics or discrete arrays.
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain is mixed down to a mono key, anything up to stereo will do
+    const auto sidechain = layouts.inputBuses.size() > 1 ? layouts.inputBuses[1] : juce::AudioChannelSet::disabled();
+    if (sidechain.size() > 2)
+        return false;
    #endif
 
     return true;
@@ -138,24 +292,12 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 #endif
 
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
-{
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),// sets up peak/bandpass filter
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
-    updateCoefficients(leftChain.get<ChainPosition::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPosition::Peak>().coefficients, peakCoefficients);
-}
-
-void SimpleEQAudioProcessor::updateCoefficients(Coefficients& old, const Coefficients& replacements)
-{
-    *old = *replacements;
-}
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
+    const RealtimeCounters::ScopedCallback callbackScope(realtimeCounters, buffer.getNumSamples(), getSampleRate());
+    PerformanceMonitor::ScopedCallback timing(performanceMonitor, buffer.getNumSamples(), getSampleRate()); //starts in parameterRead
+    auto totalNumInputChannels  = getMainBusNumInputChannels(); //the sidechain's channels come after these, there's no output for them
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     // In case we have more outputs than inputs, this code clears any output
@@ -166,180 +308,515 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
-    auto chainSettings = getChainSettings(apvts); //makes the filter with the values from our interface
-    updatePeakFilter(chainSettings);
-    auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, getSampleRate(), (chainSettings.lowCutSlope + 1) * 2);//slope(db/oct) of cutfilters known as its order - this helper function creates these filters
-    auto& leftLowCut = leftChain.get<ChainPosition::LowCut>();
-    updateCutFilter(leftLowCut, cutCoefficients,chainSettings);
-    //adding coefficients for the cut filters in the left and right channels
-/*
-    
-    leftLowCut.setBypassed<0>(true); //bypass all four of the filters in the LowCutChain 
-    leftLowCut.setBypassed<1>(true);
-    leftLowCut.setBypassed<2>(true);
-    leftLowCut.setBypassed<3>(true);
 
-    switch (chainSettings.lowCutSlope)
+    const auto kernel = chainKernel.load();
+    const auto rampLength = juce::roundToInt(smoothingTime->load() * 0.001 * getSampleRate());
+    const auto recallRampLength = juce::jmax(rampLength, juce::roundToInt(minimumRecallSeconds * getSampleRate()));
+    const auto useLinearPhase = isLinearPhase();
+    const auto useStateVariable = ! useLinearPhase && isStateVariable(); //linear phase wins, it has no topology to pick
+
+    timing.enter(PerformanceMonitor::coefficientUpdate);
+    if (isNonRealtime()) //offline renders can afford to design inline, and stay sample accurate doing so
     {
-        case Slope_12:
+        if (coefficientService.isDirty())
+            coefficientService.designNow();
+        coefficientService.notifyListenerIfPending(); //a recalled preset's FIR too, rather than whenever the design thread gets to it
+    }
+
+    //the Oversampling choice is the oversampled path's rate, once the message thread has allocated it. Another choice moves
+    //the latency, and the base path's delay with it, so there's no carrying on seamlessly like there is for a stage moving
+    //in or out of the cramped region
+    const auto settings = chainParameters.read();
+    const auto requestedFactor = getRequestedOversampling();
+    const auto availableFactor = oversampler.isAllocated(requestedFactor) ? requestedFactor : 1;
+    if (availableFactor != paths[1].factor)
+    {
+        paths[1].factor = availableFactor;
+        paths[1].isRunning = false;
+        primedSamples = fadedSamples = 0;
+
+        if (activePath == 1)
         {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //set the filter coefficient
-            leftLowCut.setBypassed<0>(false); // turn the filter back on
-            break;
+            activePath = 0;
+            startPath(0, settings);
         }
-        case Slope_24:
+        else if (paths[1].factor > 1)
         {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            leftLowCut.setBypassed<0>(false); //turns the filter back on
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            leftLowCut.setBypassed<1>(false);
-            break;
+            oversampler.resetDelay(paths[1].factor);
         }
-        case Slope_36:
+    }
+    wantedPath = getWantedPath(settings);
+
+    forEachPath([kernel](IirPath& path)
+    {
+        path.monoChain.forEach([kernel](ScalarChannelGroup& chain) { chain.setKernel(kernel); });
+        path.channelGroups.forEach([kernel](SIMDChannelGroup& group) { group.setKernel(kernel); });
+    });
+
+    if (auto* coefficients = coefficientService.pull()) //only touches the filters when the designer published something new
+    {
+        if (coefficients->changesCovered >= eventChanges) //the service read the parameters after the last event, its stages are as new as ours
+            eventStages = 0;
+
+        for (auto& path : paths)
         {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            leftLowCut.setBypassed<0>(false); //turns the filter back on
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            leftLowCut.setBypassed<1>(false);
-            *leftLowCut.get<2>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            leftLowCut.setBypassed<2>(false);
-            break;
+            if (! path.isRunning) //a path that isn't running designs for itself when it starts
+                continue;
 
+            auto design = *coefficients;
+            designStages(design, eventStages, path.factor); //queued automation may have moved these stages since the service read the parameters
+            path.smoother.setTarget(design, (design.isRecall ? recallRampLength : rampLength) * path.factor);
         }
-        case Slope_48:
+        updateChainTail();
+    }
+
+    const auto recall = recallCount.load();
+    const auto isRecalling = recall != recallCountSeen; //the values may land over more than one block, both bumps get the long glide
+    recallCountSeen = recall;
+
+    juce::dsp::AudioBlock<float> block(buffer); //processor chains need processor contexts each context has audio block that will be passed to the links in the chain
+    const auto numChannels = juce::jmin((size_t) totalNumOutputChannels, block.getNumChannels());
+    const auto numSamples = block.getNumSamples();
+
+    if (useStateVariable != svfActive) //the topologies' states mean different things, the new one starts from silence
+    {
+        svfActive = useStateVariable;
+        resetChains();
+    }
+
+    if (useLinearPhase != linearPhaseActive) //whichever path we switch to starts from silence rather than a stale state
+    {
+        linearPhaseActive = useLinearPhase;
+        if (useLinearPhase)
+            linearPhase.reset();
+        else
+            resetChains();
+    }
+
+    //the SVF designs for itself from the parameters, gliding over at least this block so automation between blocks is ramped too
+    if (useStateVariable)
+        for (auto& path : paths)
+            if (path.isRunning)
+                path.svfChain.setTarget(settings, juce::jmax(isRecalling ? recallRampLength : rampLength, (int) numSamples));
+
+    auto inputIsSilent = true;
+    for (size_t channel = 0; channel < numChannels && inputIsSilent; ++channel)
+        inputIsSilent = buffer.getMagnitude((int) channel, 0, (int) numSamples) < silenceThreshold;
+
+    if (! inputIsSilent)
+    {
+        silentSamples = 0;
+        isIdle = false;
+    }
+
+    timing.enter(PerformanceMonitor::processing);
+    const auto analyzerAttached = analyzerEnabled.load() && numChannels > 0;
+    if (analyzerAttached)
+        preEQFifo.push(block.getChannelPointer(0), (int) numSamples);
+
+    //queued automation cuts the block where it lands, between two cuts everything runs with the same parameters.
+    //Hosts may send more samples than prepareToPlay was promised, so the block is also cut into pieces no longer
+    //than that: the interleave and resampling buffers are only that big
+    const auto maxSegmentLength = (size_t) juce::jmax(1, (int) preparedSpec.maximumBlockSize);
+    for (size_t start = 0; start < numSamples;)
+    {
+        timing.enter(PerformanceMonitor::coefficientUpdate);
+        applyParameterEvents(samplePosition + (juce::int64) start, rampLength, useStateVariable);
+
+        auto end = juce::jmin(numSamples, start + maxSegmentLength);
+        if (auto* event = parameterEvents.peek())
+            end = (size_t) juce::jlimit((juce::int64) start + 1, (juce::int64) end, getEventSplit(event->samplePosition) - samplePosition);
+
+        timing.enter(PerformanceMonitor::processing);
+        processSegment(buffer, block.getSubsetChannelBlock(0, numChannels).getSubBlock(start, end - start), start, useLinearPhase, useStateVariable, timing);
+        start = end;
+    }
+    samplePosition += (juce::int64) numSamples;
+
+    if (inputIsSilent && ! isIdle)
+    {
+        //a ramp still moving the coefficients keeps the chain awake, it only counts down from the final design.
+        //The states are cleared on the way in so whatever denormal dust is left can't come back later.
+        auto isRamping = dynamicPeak.isReducing();
+        for (const auto& path : paths)
+            if (path.isRunning)
+                isRamping = isRamping || (useStateVariable ? path.svfChain.isSmoothing() : (! useLinearPhase && path.smoother.isSmoothing()));
+
+        silentSamples = isRamping ? 0 : silentSamples + (juce::int64) numSamples;
+        const auto tailSamples = useLinearPhase ? (double) linearPhase.getTailSamples()
+                                                : chainTailSamples + oversampler.getLatencySamples(getRequestedOversampling()); //what's still in the resampling or the delay
+
+        if ((double) silentSamples > tailSamples)
         {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            leftLowCut.setBypassed<0>(false); //turns the filter back on
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            leftLowCut.setBypassed<1>(false);
-            *leftLowCut.get<2>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            leftLowCut.setBypassed<2>(false);
-            *leftLowCut.get<3>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            leftLowCut.setBypassed<3>(false);
-            break;
+            isIdle = true;
+            if (useLinearPhase)
+                linearPhase.reset();
+            else
+                resetChains();
         }
     }
-    */
-    // setting coefficients for the rightLow cut filter
-    auto& rightLowCut = rightChain.get<ChainPosition::LowCut>();
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings);
 
-/*
-    rightLowCut.setBypassed<0>(true); //bypass all four of the filters in the LowCutChain 
-    rightLowCut.setBypassed<1>(true);
-    rightLowCut.setBypassed<2>(true);
-    rightLowCut.setBypassed<3>(true);
+    if (analyzerAttached)
+        postEQFifo.push(block.getChannelPointer(0), (int) numSamples);
+}
 
-    switch (chainSettings.lowCutSlope)
+void SimpleEQAudioProcessor::processSegment (juce::AudioBuffer<float>& buffer, const juce::dsp::AudioBlock<float>& segment, size_t start,
+                                             bool useLinearPhase, bool useStateVariable, PerformanceMonitor::ScopedCallback& timing) noexcept
+{
+    const auto numSamples = segment.getNumSamples();
+
+    const auto& peak = chainParameters.bands[0];
+    auto dynamicSettings = dynamicParameters.read();
+    dynamicSettings.enabled = dynamicSettings.enabled && peak.enabled->load() > 0.5f; //a disabled band has no dynamics either
+    dynamicPeak.setParameters(peak.freq->load(), peak.quality->load(), dynamicSettings);
+    const auto useDynamics = dynamicPeak.isEnabled() || dynamicPeak.isReducing(); //switching off glides back to 0 dB first
+
+    if (useDynamics && ! isIdle)
     {
-        case Slope_12:
+        //the sidechain when it's asked for and the host connected it, otherwise the input before the EQ touches it
+        if (dynamicSettings.useSidechain && getChannelCountOfBus(true, 1) > 0)
         {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0]; //set the filter coefficient
-            rightLowCut.setBypassed<0>(false); // turn the filter back on
-            break;
+            const auto sidechain = getBusBuffer(buffer, true, 1); //refers to the host's channels, nothing is copied
+            dynamicPeak.process(segment, juce::dsp::AudioBlock<const float>(sidechain).getSubBlock(start, numSamples));
         }
-        case Slope_24:
+        else
         {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            rightLowCut.setBypassed<0>(false); //turns the filter back on
-            *rightLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            rightLowCut.setBypassed<1>(false);
-            break;
+            dynamicPeak.process(segment, segment);
         }
-        case Slope_36:
-        {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            rightLowCut.setBypassed<0>(false); //turns the filter back on
-            *rightLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            rightLowCut.setBypassed<1>(false);
-            *rightLowCut.get<2>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            rightLowCut.setBypassed<2>(false);
-            break;
+    }
+
+    if (isIdle) //silence in, every state at zero: silence out, whatever the coefficients are
+    {
+        segment.clear();
+    }
+    else if (useLinearPhase) //the FIR crossfades on its own, the smoother picks up where it was when we switch back
+    {
+        linearPhase.process(segment);
+    }
+    else
+    {
+        processPaths(segment, useStateVariable, timing);
+    }
+}
+
+int SimpleEQAudioProcessor::getWantedPath (const ChainSettings& settings) const noexcept
+{
+    //the oversampled path while a stage is cramped, the resampling only costs anything while it's needed
+    return paths[1].factor > 1 && getOversamplingFactor(settings, getSampleRate()) > 1 ? 1 : 0;
+}
+
+void SimpleEQAudioProcessor::startPath (int index, const ChainSettings& settings) noexcept
+{
+    //from silence, with the settings loaded straight away for both topologies so a switch of topology can carry on from here
+    auto& path = paths[(size_t) index];
+    path.monoChain.forEach([](ScalarChannelGroup& chain) { chain.reset(); });
+    path.channelGroups.forEach([](SIMDChannelGroup& group) { group.reset(); });
+    path.smoother.reset();
+    path.smoother.setTarget(makeChainCoefficients(settings, getSampleRate(), path.factor), 0);
+    path.svfChain.setOversamplingFactor(path.factor);
+    path.svfChain.setTarget(settings, 0);
+    path.isRunning = true;
+
+    //the resampling, or the delay that lines the base rate up with it, starts empty too
+    if (path.factor > 1)
+        oversampler.resetResampling(path.factor);
+    else if (paths[1].factor > 1)
+        oversampler.resetDelay(paths[1].factor);
+
+    //long enough for those to fill, and for whatever the chain rang with from starting cold to die down by 60 dB, half its tail
+    primingLength = juce::jmax(oversampler.getLatencySamples(paths[1].factor) + crossfadeLength,
+                               juce::roundToInt(juce::jmin(chainTailSamples * 0.5, maxPrimingSeconds * getSampleRate())));
+    primedSamples = fadedSamples = 0;
+}
+
+void SimpleEQAudioProcessor::processPaths (const juce::dsp::AudioBlock<float>& block, bool useStateVariable, PerformanceMonitor::ScopedCallback& timing) noexcept
+{
+    const auto next = 1 - activePath;
+    auto& incoming = paths[(size_t) next];
+
+    if (wantedPath != activePath && ! incoming.isRunning)
+        startPath(next, chainParameters.read());
+    else if (wantedPath == activePath && incoming.isRunning && fadedSamples == 0)
+        incoming.isRunning = false; //the settings went back before the crossfade began, none of it was heard
 
+    if (! incoming.isRunning)
+    {
+        processPath(paths[(size_t) activePath], block, useStateVariable, timing);
+        return;
+    }
+
+    //the same audio through both, the path we're going to works on a copy
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    auto incomingBlock = oversampler.getSpareBlock(paths[1].factor, numChannels, numSamples);
+    incomingBlock.copyFrom(block);
+    processPath(incoming, incomingBlock, useStateVariable, timing);
+    processPath(paths[(size_t) activePath], block, useStateVariable, timing);
+
+    if (primedSamples < primingLength) //its states are still catching up, only the active path is heard
+    {
+        primedSamples += (int) numSamples;
+        return;
+    }
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* output = block.getChannelPointer(channel);
+        const auto* input = incomingBlock.getChannelPointer(channel);
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto gain = juce::jmin(1.f, (float) (fadedSamples + (int) i + 1) / (float) crossfadeLength);
+            output[i] += (input[i] - output[i]) * gain;
         }
-        case Slope_48:
+    }
+
+    fadedSamples += (int) numSamples;
+    if (fadedSamples >= crossfadeLength) //the other path has taken over, the one we left stops until it's wanted again
+    {
+        paths[(size_t) activePath].isRunning = false;
+        activePath = next;
+        fadedSamples = 0;
+    }
+}
+
+void SimpleEQAudioProcessor::processPath (IirPath& path, const juce::dsp::AudioBlock<float>& block, bool useStateVariable,
+                                          PerformanceMonitor::ScopedCallback& timing) noexcept
+{
+    auto processChain = [&](const juce::dsp::AudioBlock<float>& chainBlock)
+    {
+        if (useStateVariable)
+            path.svfChain.process(chainBlock);
+        else
+            processBiquads(path, chainBlock, timing);
+    };
+
+    if (path.factor > 1)
+    {
+        oversampler.process(block, path.factor, processChain);
+        return;
+    }
+
+    processChain(block);
+    if (paths[1].factor > 1) //lined up with the resampling whenever a factor is asked for, cramped stage or not
+        oversampler.delay(block, paths[1].factor);
+}
+
+void SimpleEQAudioProcessor::processBiquads (IirPath& path, const juce::dsp::AudioBlock<float>& block, PerformanceMonitor::ScopedCallback& timing) noexcept
+{
+    auto& smoother = path.smoother;
+    const auto numSamples = block.getNumSamples();
+
+    //while a ramp is running the block is cut into sub-blocks with the coefficients nudged in between,
+    //once it's done the whole (rest of the) block goes through in one go
+    for (size_t offset = 0; offset < numSamples;)
+    {
+        timing.enter(PerformanceMonitor::coefficientUpdate);
+        if (auto* coefficients = smoother.next())
+            applyCoefficientsToChains(path, *coefficients);
+        timing.enter(PerformanceMonitor::processing);
+
+        const auto length = smoother.isSmoothing() ? juce::jmin((size_t) smoother.getSamplesUntilNextStep(), numSamples - offset)
+                                                   : numSamples - offset;
+        processChannels(path, block.getSubBlock(offset, length));
+        smoother.advance((int) length);
+        offset += length;
+    }
+}
+
+bool SimpleEQAudioProcessor::queueParameterChange (int parameterIndex, float value, juce::int64 position)
+{
+    if (! juce::isPositiveAndBelow(parameterIndex, (int) eventTargets.size()))
+        return false;
+
+    const auto normalisedValue = eventTargets[(size_t) parameterIndex].parameter->convertTo0to1(value);
+    return parameterEvents.push({ position, parameterIndex, normalisedValue });
+}
+
+void SimpleEQAudioProcessor::applyParameterEvents (juce::int64 position, int rampLength, bool useStateVariable) noexcept
+{
+    juce::uint64 stages = 0;
+    auto anyApplied = false;
+
+    for (auto* event = parameterEvents.peek(); event != nullptr && getEventSplit(event->samplePosition) <= position; event = parameterEvents.peek())
+    {
+        //applied quietly: telling the host would hand its own automation back to it as a gesture to record, and would run
+        //every listener on this thread. The parameter keeps the value for the host and the state to read back, the raw
+        //value is what the chain reads, and the editor picks it up from appliedEventCount
+        const auto& target = eventTargets[(size_t) event->parameterIndex];
+        target.parameter->setValue(event->value);
+        target.rawValue->store(target.parameter->convertFrom0to1(target.parameter->getValue())); //snapped, for choices and bools
+        stages |= target.stages;
+        anyApplied = true;
+        parameterEvents.pop();
+    }
+
+    if (! anyApplied)
+        return;
+
+    eventChanges = coefficientService.markDirty(); //its next design, the one the editor draws, includes the new values
+    appliedEventCount.fetch_add(1, std::memory_order_release);
+
+    const auto settings = chainParameters.read();
+    wantedPath = getWantedPath(settings); //a stage may have moved in or out of the cramped region
+    eventStages |= stages;
+
+    for (auto& path : paths)
+    {
+        if (! path.isRunning)
+            continue;
+
+        if (path.smoother.hasTarget())
         {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            rightLowCut.setBypassed<0>(false); //turns the filter back on
-            *rightLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            rightLowCut.setBypassed<1>(false);
-            *rightLowCut.get<2>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            rightLowCut.setBypassed<2>(false);
-            *rightLowCut.get<3>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            rightLowCut.setBypassed<3>(false);
-            break;
+            //only the stages the events touched are designed again, on top of the design we're already heading for
+            auto design = path.smoother.getTarget();
+            designStages(design, stages, path.factor);
+            path.smoother.setTarget(design, rampLength * path.factor);
         }
+
+        if (useStateVariable) //designs only if something it uses changed
+            path.svfChain.setTarget(settings, juce::jmax(rampLength, parameterEventGrid));
     }
-*/
-    juce::dsp::AudioBlock<float> block(buffer); //processor chains need processor contexts each context has audio block that will be passed to the links in the chain
-    auto leftBlock = block.getSingleChannelBlock(0); //extracts left channnel audio into a block
-    auto rightBlock = block.getSingleChannelBlock(1);
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock); //Passes the block to the audio context
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-    //now we can pass the context to the chains
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+
+    updateChainTail();
 }
 
-//==============================================================================
-bool SimpleEQAudioProcessor::hasEditor() const
+void SimpleEQAudioProcessor::designStages (ChainCoefficients& coefficients, juce::uint64 stages, int factor) noexcept
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    const auto settings = chainParameters.read();
+
+    //a design for another rate, like the service's with a cramped stage for the base rate path, is redone whole at this one
+    if (coefficients.oversamplingFactor != factor)
+    {
+        const auto version = coefficients.version;
+        const auto isRecall = coefficients.isRecall;
+        coefficients = makeChainCoefficients(settings, getSampleRate(), factor);
+        coefficients.version = version;
+        coefficients.isRecall = isRecall;
+        return;
+    }
+
+    if (stages == 0)
+        return;
+
+    const auto sampleRate = getSampleRate() * factor;
+
+    for (int band = 0; band < maxNumBands; ++band)
+        if ((stages & getStageBit(band)) != 0)
+            designBand(coefficients, settings, band, sampleRate);
+
+    if ((stages & getStageBit(lowCutStage)) != 0)
+        designLowCut(coefficients, settings, sampleRate);
+
+    if ((stages & getStageBit(highCutStage)) != 0)
+        designHighCut(coefficients, settings, sampleRate);
+}
+
+void SimpleEQAudioProcessor::updateChainTail() noexcept
+{
+    const auto& smoother = paths[(size_t) activePath].smoother;
+    if (smoother.hasTarget()) //the tail of the design the heard path is heading for
+        chainTailSamples = juce::jmin(getTailLengthInSamples(smoother.getTarget()), maxTailSeconds * getSampleRate());
+}
+
+void SimpleEQAudioProcessor::chainCoefficientsDesigned (const ChainCoefficients& coefficients)
+{
+    designedTailSamples = getTailLengthInSamples(coefficients);
+
+    const auto useLinearPhase = isLinearPhase();
+    if (useLinearPhase) //the toggle is a parameter too, so switching it on always lands here with a fresh design
+        linearPhase.design(coefficients);
+
+    //a factor asked for for the first time is allocated on the message thread, which reports its latency after.
+    //Until the message loop gets to it the chain keeps to the base rate, a host that never runs one only has the
+    //factors prepareToPlay allocated: the one chosen then, or all of them for a non-realtime render
+    if (getLatencyForParameters() != reportedLatency.load() || ! oversampler.isAllocated(getRequestedOversampling()))
+        triggerAsyncUpdate();
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void SimpleEQAudioProcessor::handleAsyncUpdate()
 {
-    ChainSettings settings;
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load(); //getRawParamValue returns the value in units that are meaningful (db,Hz, db/oct) rather than normalized values
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load(); //loads the param values into an instance of the struct
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    return settings;
+    prepareOversampling(getRequestedOversampling());
+    updateLatency();
+}
 
+int SimpleEQAudioProcessor::getLatencyForParameters() const noexcept
+{
+    //the IIR paths are delayed to the resampling's latency whenever a factor is asked for, cramped stage or not
+    return isLinearPhase() ? linearPhase.getLatencySamples() : oversampler.getLatencySamples(getRequestedOversampling());
 }
 
+void SimpleEQAudioProcessor::updateLatency()
+{
+    reportedLatency = getLatencyForParameters();
+    setLatencySamples(reportedLatency.load());
+}
+
+void SimpleEQAudioProcessor::applyCoefficientsToChains (IirPath& path, const ChainCoefficients& coefficients) noexcept
+{
+    path.monoChain.forEach([&coefficients](ScalarChannelGroup& chain) { chain.apply(coefficients); });
+    path.channelGroups.forEach([&coefficients](SIMDChannelGroup& group) { group.apply(coefficients); });
+}
+
+void SimpleEQAudioProcessor::resetChains() noexcept
+{
+    forEachPath([](IirPath& path)
+    {
+        path.monoChain.forEach([](ScalarChannelGroup& chain) { chain.reset(); });
+        path.channelGroups.forEach([](SIMDChannelGroup& group) { group.reset(); });
+        path.svfChain.reset();
+    });
+    dynamicPeak.reset();
+    oversampler.reset();
+}
+
+void SimpleEQAudioProcessor::processChannels (IirPath& path, const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numChannels = block.getNumChannels();
+
+    if (numChannels == 1 && path.monoChain.size() > 0)
+    {
+        path.monoChain.getUnchecked(0).process(block);
+        return;
+    }
+
+    currentBlock = block;
+    currentPath = &path;
+    const auto numGroups = juce::jmin(path.channelGroups.size(), (int) ((numChannels + SIMDChannelGroup::laneCount - 1) / SIMDChannelGroup::laneCount));
+
+    if (workerPool.has_value())
+        (*workerPool)->run([](void* processor, int groupIndex) { static_cast<SimpleEQAudioProcessor*>(processor)->processChannelGroup(groupIndex); },
+                           this, numGroups, blockPeriodSeconds);
+    else
+        for (int i = 0; i < numGroups; ++i)
+            processChannelGroup(i);
+}
+
+void SimpleEQAudioProcessor::processChannelGroup (int groupIndex) noexcept
+{
+    constexpr auto laneCount = SIMDChannelGroup::laneCount;
+    const auto firstChannel = (size_t) groupIndex * laneCount;
+    const auto numChannels = juce::jmin(laneCount, currentBlock.getNumChannels() - firstChannel);
+    currentPath->channelGroups.getUnchecked(groupIndex).process(currentBlock.getSubsetChannelBlock(firstChannel, numChannels));
+}
+
+//==============================================================================
+bool SimpleEQAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
 {
+    //the IDs, ranges and choices are made once per process, each instance only gets parameter objects of its own
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq", 
-                                                           "LowCut Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f,0.25f), 20.f));//creates a pointer that gets cleaned up when its out of scope
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq",
-                                                           "HighCut Freq",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f,1.f, 0.25f), 20000.f)); //argument list (label,label,low range of slider, high range,step size,pot taper), default value
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq",
-                                                           "Peak Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f)); //argument list (label,label,low range of slider, high range,step size,pot taper), default value
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain",
-                                                           "Peak Gain",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 0.25f), 20000.f)); //argument list (label,label,low range of slider, high range,step size,pot taper), default value
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality",
-                                                           "Peak Quality",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 0.25f), 1.f)); //argument list (label,label,low range of slider, high range,step size,pot taper), default value
-    juce::StringArray stringArray;
-    for (int i = 0; i < 4; i++)
-    {
-
-        //for slope choice 0: 12 db/oct we need an order of 2 (1 coeff)
-        //for slope choice 1: 24 db/oct we need an order of 4 (2 coeff)
-        juce::String str;
-        str << (12 +( i * 12));
-        str << " db/Oct";
-        stringArray.add(str);
-    }
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0)); //this makes a control like a dropdown of choices
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+    for (const auto& info : getParameterInfos())
+        layout.add(info.create());
     return layout;
 }
 
 juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
 {
-   // return new SimpleEQAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new SimpleEQAudioProcessorEditor (*this);
 }
 
 //==============================================================================
@@ -348,12 +825,35 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
+    auto state = PluginState::capture(apvts);
+
+    //the current design goes along so a restore at the same rate doesn't have to redo it,
+    //unless a change is still waiting to be designed and it would be stale
+    if (! coefficientService.isDirty() && coefficientService.getLatestVersion() > 0)
+    {
+        state.coefficients = coefficientService.getLatestCoefficients(&state.sampleRate);
+        state.hasCoefficients = true;
+    }
+
+    juce::MemoryOutputStream stream(destData, false);
+    state.write(stream);
 }
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+    PluginState state;
+    juce::MemoryInputStream stream(data, (size_t) sizeInBytes, false);
+    if (! state.read(stream))
+        return;
+
+    coefficientService.applyPredesigned(state.hasCoefficients ? &state.coefficients : nullptr, state.sampleRate, [this, &state]
+    {
+        ++recallCount;
+        state.applyTo(apvts);
+        ++recallCount;
+    });
 }
 
 //==============================================================================
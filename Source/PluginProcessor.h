@@ -9,29 +9,31 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48,
-};
-
-struct ChainSettings // a data structure to store all the parameters from the AudioProcessor
-{
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-    int lowCutSlope{Slope::Slope_12}, highCutSlope{ Slope::Slope_12 };
-};
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts); //Will return a struct with the values of our params
-
+#include "FilterChain.h"
+#include "ParameterInfo.h"
+#include "CoefficientService.h"
+#include "ChannelGroupChain.h"
+#include "ChannelGroupArena.h"
+#include "ChannelWorkerPool.h"
+#include "CoefficientSmoother.h"
+#include "ParameterEventQueue.h"
+#include "LinearPhaseConvolver.h"
+#include "SvfChain.h"
+#include "ChainOversampler.h"
+#include "DynamicPeak.h"
+#include "AnalyzerFifo.h"
+#include "RealtimeCounters.h"
+#include "PerformanceMonitor.h"
+#include "PluginState.h"
+#include "PresetBank.h"
 
 //==============================================================================
 /**
 */
 //Audio Processor for the program
-class SimpleEQAudioProcessor  : public juce::AudioProcessor 
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private CoefficientService::Listener,
+                                private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -73,72 +75,148 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-private: //dsp will only process a single channel of audio at once
-    using Filter = juce::dsp::IIR::Filter<float>; //type alias
-    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>; //each filter is 12db/oct by default - this chain gives us 4x12 =4 8db/oct
-    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;//processor chains process all the audio its passed in a context with whats in your chain
-    MonoChain leftChain, rightChain; //since dsp is mono by default and were writing a stereo plugin
-    enum ChainPosition
+    static constexpr int maxNumChannels = 64;
+    void setParallelChannelThreshold (int numChannels) { parallelChannelThreshold = numChannels; } //takes effect on the next prepareToPlay
+    void setChainKernel (ChainKernel newKernel) { chainKernel = newKernel; } //for A/B comparisons, picked up at the start of the next block
+    KernelIsa getKernelIsa() const noexcept { return kernelIsa; } //the instruction set the biquad kernels were built for, set in prepareToPlay
+
+    //the editor's analyzer reads these, processBlock only copies into them while one is attached
+    AnalyzerFifo& getPreEQFifo() noexcept { return preEQFifo; }
+    AnalyzerFifo& getPostEQFifo() noexcept { return postEQFifo; }
+    void setAnalyzerEnabled (bool shouldBeEnabled); //message thread, the FIFOs are allocated the first time
+    RealtimeCounters& getRealtimeCounters() noexcept { return realtimeCounters; }
+    PerformanceMonitor& getPerformanceMonitor() noexcept { return performanceMonitor; } //per section timings of processBlock
+    const CoefficientService& getCoefficientService() const noexcept { return coefficientService; } //the editor draws the latest design
+
+    bool loadPresetBank (const juce::File& file); //the bank's presets become the host's programs
+
+    /** Queues a change of getParameters()[parameterIndex] to value, in the parameter's own units (Hz, dB...), at samplePosition.
+        Positions count the samples processBlock has been given since prepareToPlay, and the change is applied at the start
+        of the parameterEventGrid step it falls in, so where it lands doesn't depend on how the host cuts up the audio.
+        One producer thread at a time, in time order. False if there's no such parameter, the queue is full or prepareToPlay hasn't run yet.
+    */
+    bool queueParameterChange (int parameterIndex, float value, juce::int64 samplePosition);
+    static constexpr int parameterEventGrid = CoefficientSmoother::subBlockSize; //the finest a block is ever cut for events
+
+    /** Goes up whenever processBlock applies queued changes. Those don't notify anyone, an editor polls this and reads the values back. */
+    juce::uint32 getAppliedEventCount() const noexcept { return appliedEventCount.load(std::memory_order_acquire); }
+
+private:
+    //every channel runs the same chain with the same coefficients, so channels are packed into SIMD groups.
+    //A path is the IIR chain at one rate: its channels, the smoother ramping their designs and the SVF alternative
+    struct IirPath
     {
-        LowCut,
-        Peak,
-        HighCut
+        ChannelGroupArena<SIMDChannelGroup> channelGroups; //one per SIMDChannelGroup::laneCount channels, side by side in one allocation from prepareToPlay
+        ChannelGroupArena<ScalarChannelGroup> monoChain; //mono layouts don't need to pay for the interleaving, only prepared for them
+        CoefficientSmoother smoother; //ramps between the designs so automation doesn't zipper
+        SvfChain svfChain;
+        int factor{ 1 }; //the rate the designs and the states are for, as a multiple of the host's
+        bool isRunning{ false };
     };
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    using Coefficients = Filter::CoefficientsPtr;
-    static void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-    template<typename ChainType, typename CoefficientType>
-    void updateCutFilter(ChainType& leftLowCut,
-        const CoefficientType& cutCoefficients,
-        const ChainSettings& chainSettings)
+    int parallelChannelThreshold{ 16 }; //layouts with at least this many channels get split across workers
+    std::optional<juce::SharedResourcePointer<ChannelWorkerPool>> workerPool; //the process-wide pool, only held while this layout uses it
+    double blockPeriodSeconds{ 0.0 }; //how long the workers stay hot after a job
+    juce::dsp::AudioBlock<float> currentBlock; //the block the workers are processing
+    IirPath* currentPath{ nullptr }; //and whose groups they run it through
+    void processChannelGroup (int groupIndex) noexcept;
+    void processChannels (IirPath& path, const juce::dsp::AudioBlock<float>& block) noexcept;
+    void applyCoefficientsToChains (IirPath& path, const ChainCoefficients& coefficients) noexcept;
+    void processSegment (juce::AudioBuffer<float>& buffer, const juce::dsp::AudioBlock<float>& segment, size_t start,
+                         bool useLinearPhase, bool useStateVariable, PerformanceMonitor::ScopedCallback& timing) noexcept;
+    void processBiquads (IirPath& path, const juce::dsp::AudioBlock<float>& block, PerformanceMonitor::ScopedCallback& timing) noexcept;
+    void resetChains() noexcept;
+    CoefficientService coefficientService{ apvts }; //designs the filters in the background, must come after apvts
+    std::atomic<float>* smoothingTime{ nullptr }; //looked up once so the audio thread never searches by name
+
+    //a program change or a restored state moves every stage at once, so it always glides, even with Smoothing Time at 0
+    static constexpr double minimumRecallSeconds = 0.02;
+    std::atomic<juce::uint32> recallCount{ 0 }; //bumped either side of applying a program's or a state's values, for the SVF which reads them itself
+    juce::uint32 recallCountSeen{ 0 }; //audio thread's view
+    std::atomic<ChainKernel> chainKernel{ ChainKernel::processorChain };
+    KernelIsa kernelIsa{ KernelIsa::scalar };
+
+    //linear phase mode runs the same magnitude response as an FIR instead of the IIR chains
+    LinearPhaseConvolver linearPhase;
+    std::atomic<float>* linearPhaseMode{ nullptr };
+    bool linearPhaseActive{ false }; //audio thread's view, so switching can clear the path we switch to
+    std::atomic<int> reportedLatency{ 0 }; //what we last told the host
+    bool isLinearPhase() const noexcept { return linearPhaseMode->load() > 0.5f; }
+
+    //either IIR topology runs oversampled while a stage sits close enough to Nyquist for its curve to be squeezed.
+    //The base rate path and the oversampled one are lined up, and moving between them primes the one we're going to
+    //with the same audio until its states have caught up, then crossfades over a sub-block: nothing is reset mid-stream
+    ChainOversampler oversampler;
+    std::atomic<float>* oversamplingMode{ nullptr };
+    std::array<IirPath, 2> paths; //the base rate and the Oversampling choice, the second only runs while needed
+    int activePath{ 0 }; //the one that's heard
+    int wantedPath{ 0 }; //the one the settings ask for, set whenever they're read
+    int primingLength{ 0 }, primedSamples{ 0 }, fadedSamples{ 0 }; //while the other path runs too
+    static constexpr double maxPrimingSeconds = 0.25;
+    static constexpr int crossfadeLength = CoefficientSmoother::subBlockSize;
+    int getRequestedOversampling() const noexcept { return 1 << (int) oversamplingMode->load(); }
+    int getLatencyForParameters() const noexcept;
+    juce::dsp::ProcessSpec preparedSpec{}; //what prepareToPlay was given, for building the oversampled path later
+    int preparedNumChannels{ 0 };
+    bool oversampledPathPrepared{ false }; //message thread's view
+    void preparePath (IirPath& path, int factor); //message thread, while the audio thread isn't using the path
+    void prepareOversampling (int factor); //message thread, a no-op once the factor is there
+    int getWantedPath (const ChainSettings& settings) const noexcept;
+    void startPath (int index, const ChainSettings& settings) noexcept;
+    void processPaths (const juce::dsp::AudioBlock<float>& block, bool useStateVariable, PerformanceMonitor::ScopedCallback& timing) noexcept;
+    void processPath (IirPath& path, const juce::dsp::AudioBlock<float>& block, bool useStateVariable, PerformanceMonitor::ScopedCallback& timing) noexcept;
+    template <typename Function>
+    void forEachPath (Function&& function) noexcept //the oversampled path only while a factor is asked for
     {
-        leftLowCut.setBypassed<0>(true); //bypass all four of the filters in the LowCutChain 
-        leftLowCut.setBypassed<1>(true);
-        leftLowCut.setBypassed<2>(true);
-        leftLowCut.setBypassed<3>(true);
-
-        switch (chainSettings.lowCutSlope)
-        {
-        case Slope_12:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //set the filter coefficient
-            leftLowCut.setBypassed<0>(false); // turn the filter back on
-            break;
-        }
-        case Slope_24:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            leftLowCut.setBypassed<0>(false); //turns the filter back on
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            leftLowCut.setBypassed<1>(false);
-            break;
-        }
-        case Slope_36:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            leftLowCut.setBypassed<0>(false); //turns the filter back on
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            leftLowCut.setBypassed<1>(false);
-            *leftLowCut.get<2>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            leftLowCut.setBypassed<2>(false);
-            break;
-
-        }
-        case Slope_48:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0]; //since its a second order filter two coefficients are returned
-            leftLowCut.setBypassed<0>(false); //turns the filter back on
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1]; //set the filter coefficient
-            leftLowCut.setBypassed<1>(false);
-            *leftLowCut.get<2>().coefficients = *cutCoefficients[2]; //set the filter coefficient
-            leftLowCut.setBypassed<2>(false);
-            *leftLowCut.get<3>().coefficients = *cutCoefficients[3]; //set the filter coefficient
-            leftLowCut.setBypassed<3>(false);
-            break;
-        }
-        }
-
+        function(paths[0]);
+        if (paths[1].factor > 1)
+            function(paths[1]);
     }
+
+    //the state variable topology designs and ramps on the audio thread, per sample, the biquads' design is still what the editor and the tail use
+    ChainParameters chainParameters{ apvts };
+    std::atomic<float>* filterTopology{ nullptr };
+    bool svfActive{ false }; //audio thread's view, like linearPhaseActive
+    bool isStateVariable() const noexcept { return filterTopology->load() > 0.5f; }
+
+    //queued automation, applied where it lands in the block with only the stages it touches designed again, on the audio thread
+    static constexpr int lowCutStage = ParameterInfo::lowCutStage, highCutStage = ParameterInfo::highCutStage; //bit numbers in a stage mask, the bands come first
+    static_assert (highCutStage < 64, "every stage needs a bit");
+    static constexpr juce::uint64 getStageBit (int stage) noexcept { return juce::uint64 (1) << stage; }
+    static juce::int64 getEventSplit (juce::int64 position) noexcept { return position - position % parameterEventGrid; }
+    struct EventTarget { juce::RangedAudioParameter* parameter; std::atomic<float>* rawValue; juce::uint64 stages; };
+    std::vector<EventTarget> eventTargets; //one per getParameters() entry, filled in the constructor
+    static constexpr int maxQueuedEvents = 8192;
+    ParameterEventQueue parameterEvents; //room is made in prepareToPlay, nothing can be queued before it
+    juce::int64 samplePosition{ 0 }; //of the current block's first sample
+    juce::uint64 eventStages{ 0 }; //every stage the audio thread designed itself, redone on top of the service's designs until one covers them
+    juce::uint32 eventChanges{ 0 }; //the service's change count for the newest of those events
+    std::atomic<juce::uint32> appliedEventCount{ 0 };
+    void applyParameterEvents (juce::int64 position, int rampLength, bool useStateVariable) noexcept;
+    void designStages (ChainCoefficients& coefficients, juce::uint64 stages, int factor) noexcept;
+    void updateChainTail() noexcept;
+
+    //the Peak band's dynamic mode runs ahead of whichever path is active, keyed by the main input or the sidechain bus
+    DynamicPeak dynamicPeak;
+    DynamicParameters dynamicParameters{ apvts };
+    void chainCoefficientsDesigned (const ChainCoefficients& coefficients) override; //design thread or an offline processBlock, the FIR is built right after the IIR
+    void handleAsyncUpdate() override; //the latency can only be reported, and the resampling allocated, from the message thread
+    void updateLatency();
+
+    //once the input has been silent for longer than the tail, every state has rung out and the whole chain is skipped
+    static constexpr float silenceThreshold = 1.0e-8f; //-160 dB, anything quieter counts as digital silence
+    static constexpr double maxTailSeconds = 10.0; //a very narrow low peak can ring for longer than anyone can hear
+    std::atomic<double> designedTailSamples{ 0.0 }; //IIR tail of the latest design, for getTailLengthSeconds
+    double chainTailSamples{ 0.0 }; //audio thread's view, the tail of the design it is heading for
+    juce::int64 silentSamples{ 0 };
+    bool isIdle{ false };
+
+    AnalyzerFifo preEQFifo, postEQFifo; //channel 0 before and after the EQ
+    std::atomic<bool> analyzerEnabled{ false };
+    RealtimeCounters realtimeCounters;
+    PerformanceMonitor performanceMonitor;
+
+    std::shared_ptr<const PresetBank> presetBank; //read only, so instances that load the same bank share it
+    int currentPreset{ 0 };
     //==============================================================================t
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
 };
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    PluginState.cpp
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+
+PluginState PluginState::capture(juce::AudioProcessorValueTreeState& apvts)
+{
+    PluginState state;
+    for (auto* parameter : apvts.processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            state.values.emplace_back(ranged->paramID, ranged->convertFrom0to1(ranged->getValue()));
+
+    return state;
+}
+
+void PluginState::applyTo(juce::AudioProcessorValueTreeState& apvts) const
+{
+    for (const auto& [parameterID, value] : values)
+        if (auto* parameter = apvts.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+void PluginState::write(juce::OutputStream& stream) const
+{
+    stream.writeInt((int) magic);
+    stream.writeShort((short) formatVersion);
+    stream.writeShort((short) values.size());
+
+    for (const auto& [parameterID, value] : values)
+    {
+        const auto id = parameterID.toUTF8();
+        const auto length = (int) juce::jmin((size_t) 255, id.sizeInBytes() - 1);
+        stream.writeByte((char) length);
+        stream.write(id.getAddress(), (size_t) length);
+        stream.writeFloat(value);
+    }
+
+    stream.writeBool(hasCoefficients);
+    if (hasCoefficients)
+    {
+        stream.writeDouble(sampleRate);
+        writeChainCoefficients(stream, coefficients);
+    }
+}
+
+bool PluginState::read(juce::InputStream& stream)
+{
+    if ((juce::uint32) stream.readInt() != magic)
+        return false;
+
+    const auto version = (int) stream.readShort();
+    if (version > formatVersion) //written by a newer build, better keep what we have than guess
+        return false;
+
+    PluginState state;
+    const auto numValues = (int) (juce::uint16) stream.readShort();
+    state.values.reserve((size_t) numValues);
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        if (stream.isExhausted()) //truncated
+            return false;
+
+        char id[256];
+        const auto length = (int) (juce::uint8) stream.readByte();
+        if (stream.read(id, length) != length)
+            return false;
+
+        state.values.emplace_back(juce::String::fromUTF8(id, length), stream.readFloat());
+    }
+
+    if (stream.isExhausted())
+        return false;
+
+    state.hasCoefficients = stream.readBool();
+    //designed for the single peak chain, without a factor, or with a parked cut left out that is audible at its rate:
+    //the values are all we can use, the design is done again
+    if (state.hasCoefficients && version < 4)
+    {
+        state.hasCoefficients = false;
+    }
+    else if (state.hasCoefficients)
+    {
+        if (stream.getNumBytesRemaining() < (juce::int64) sizeof(double) + chainCoefficientsSize)
+            return false;
+
+        state.sampleRate = stream.readDouble();
+        readChainCoefficients(stream, state.coefficients);
+    }
+
+    *this = std::move(state);
+    return true;
+}
+
+void writeChainCoefficients(juce::OutputStream& stream, const ChainCoefficients& coefficients)
+{
+    auto writeBiquad = [&stream](const BiquadCoefficients& biquad)
+    {
+        for (auto coefficient : biquad)
+            stream.writeFloat(coefficient);
+    };
+
+    for (int band = 0; band < maxNumBands; ++band)
+        writeBiquad(coefficients.bands.get(band));
+    for (const auto& biquad : coefficients.lowCut)
+        writeBiquad(biquad);
+    for (const auto& biquad : coefficients.highCut)
+        writeBiquad(biquad);
+
+    stream.writeByte((char) coefficients.lowCutSlope);
+    stream.writeByte((char) coefficients.highCutSlope);
+    stream.writeByte((char) coefficients.oversamplingFactor);
+}
+
+void readChainCoefficients(juce::InputStream& stream, ChainCoefficients& coefficients)
+{
+    auto readBiquad = [&stream](BiquadCoefficients& biquad)
+    {
+        for (auto& coefficient : biquad)
+            coefficient = stream.readFloat();
+    };
+
+    for (int band = 0; band < maxNumBands; ++band)
+    {
+        BiquadCoefficients biquad;
+        readBiquad(biquad);
+        coefficients.bands.set(band, biquad);
+    }
+    for (auto& biquad : coefficients.lowCut)
+        readBiquad(biquad);
+    for (auto& biquad : coefficients.highCut)
+        readBiquad(biquad);
+
+    coefficients.lowCutSlope = juce::jlimit((int) Slope_Off, (int) Slope_48, (int) stream.readByte());
+    coefficients.highCutSlope = juce::jlimit((int) Slope_Off, (int) Slope_48, (int) stream.readByte());
+    coefficients.oversamplingFactor = juce::jlimit(1, maxOversamplingFactor, (int) stream.readByte());
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    PluginState.h
+
+    Compact, versioned binary form of the plugin state. Every parameter is
+    stored as its ID and real world value, followed by the coefficients that
+    were designed for those values (and the rate they were designed at), so
+    a restore at the same rate doesn't need to design anything.
+
+    Layout, little endian:
+        "SEQS" magic, uint16 format version, uint16 parameter count
+        per parameter: uint8 ID length, ID bytes (UTF-8), float value
+        uint8 has coefficients, then double sample rate and the raw ChainCoefficients
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+struct PluginState
+{
+    static constexpr juce::uint32 magic = 0x53514553; //"SEQS" in little endian
+    static constexpr int formatVersion = 4; //2: one biquad per band instead of the single peak, 3: the oversampling factor,
+                                            //4: a parked cut is only left out when it's inaudible, same layout as 3
+
+    std::vector<std::pair<juce::String, float>> values; //parameter ID, real world value
+    bool hasCoefficients{ false };
+    double sampleRate{ 0.0 };
+    ChainCoefficients coefficients;
+
+    static PluginState capture(juce::AudioProcessorValueTreeState& apvts);
+    void applyTo(juce::AudioProcessorValueTreeState& apvts) const; //IDs the processor doesn't know are skipped, missing ones keep their value
+
+    void write(juce::OutputStream& stream) const;
+    bool read(juce::InputStream& stream); //returns false if this isn't a state we can read, leaving it unchanged
+};
+
+//raw ChainCoefficients, also used by the preset bank: 5 floats per band and cut stage, then the two slopes and the oversampling factor as bytes
+constexpr int chainCoefficientsSize = (maxNumBands + 8) * 5 * 4 + 3;
+void writeChainCoefficients(juce::OutputStream& stream, const ChainCoefficients& coefficients);
+void readChainCoefficients(juce::InputStream& stream, ChainCoefficients& coefficients);
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+static juce::String readFixedString(const char* source)
+{
+    return juce::String::fromUTF8(source, (int) strnlen(source, PresetBank::nameSize));
+}
+
+static void writeFixedString(juce::OutputStream& stream, const juce::String& text)
+{
+    char buffer[PresetBank::nameSize] = {};
+    text.copyToUTF8(buffer, sizeof(buffer) - 1); //always leaves a terminating zero
+    stream.write(buffer, sizeof(buffer));
+}
+
+PresetBank::PresetBank(const juce::File& file)
+{
+    mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto size = mappedFile->getSize();
+    data = static_cast<const char*>(mappedFile->getData());
+
+    constexpr size_t headerSize = 4 + 2 + 2 + 4 + 4;
+    if (data == nullptr || size < headerSize)
+        return;
+
+    juce::MemoryInputStream header(data, size, false);
+    if ((juce::uint32) header.readInt() != magic)
+        return;
+
+    const auto version = (int) header.readShort();
+    if (version < 3 || version > formatVersion) //the record layout changed before 3
+        return;
+
+    const auto rates = (int) header.readShort();
+    const auto presets = header.readInt();
+    const auto parameters = header.readInt();
+    if (rates <= 0 || rates > maxNumSampleRates || presets <= 0 || parameters <= 0)
+        return;
+
+    for (int i = 0; i < rates; ++i)
+        sampleRates[i] = header.readDouble();
+
+    parametersOffset = headerSize + (size_t) rates * sizeof(double);
+    recordsOffset = parametersOffset + (size_t) parameters * nameSize;
+    recordSize = nameSize + (size_t) parameters * sizeof(float) + (size_t) rates * chainCoefficientsSize;
+
+    if (recordsOffset + (size_t) presets * recordSize > size) //truncated, don't trust any of it
+        return;
+
+    numSampleRates = rates;
+    numParameters = parameters;
+    numPresets = presets;
+    hasCurrentDesigns = version == formatVersion;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    return juce::isPositiveAndBelow(index, numPresets) ? readFixedString(getRecord(index)) : juce::String();
+}
+
+void PresetBank::applyValues(int index, juce::AudioProcessorValueTreeState& apvts) const
+{
+    if (! juce::isPositiveAndBelow(index, numPresets))
+        return;
+
+    juce::MemoryInputStream values(getRecord(index) + nameSize, (size_t) numParameters * sizeof(float), false);
+    for (int i = 0; i < numParameters; ++i)
+    {
+        const auto value = values.readFloat();
+        if (auto* parameter = apvts.getParameter(readFixedString(data + parametersOffset + (size_t) i * nameSize)))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+}
+
+bool PresetBank::getCoefficients(int index, double sampleRate, ChainCoefficients& result) const
+{
+    if (! hasCurrentDesigns || ! juce::isPositiveAndBelow(index, numPresets))
+        return false;
+
+    for (int i = 0; i < numSampleRates; ++i)
+    {
+        if (sampleRates[i] != sampleRate)
+            continue;
+
+        const auto* design = getRecord(index) + nameSize + (size_t) numParameters * sizeof(float) + (size_t) i * chainCoefficientsSize;
+        juce::MemoryInputStream stream(design, chainCoefficientsSize, false);
+        readChainCoefficients(stream, result);
+        return true;
+    }
+
+    return false;
+}
+
+bool PresetBank::write(const juce::File& file, const std::vector<Preset>& presets, juce::AudioProcessorValueTreeState& scratch,
+                       const std::vector<double>& rates)
+{
+    jassert(! presets.empty() && ! rates.empty() && (int) rates.size() <= maxNumSampleRates);
+
+    juce::Array<juce::RangedAudioParameter*> parameters;
+    for (auto* parameter : scratch.processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            parameters.add(ranged);
+
+    juce::MemoryOutputStream stream;
+    stream.writeInt((int) magic);
+    stream.writeShort((short) formatVersion);
+    stream.writeShort((short) rates.size());
+    stream.writeInt((int) presets.size());
+    stream.writeInt(parameters.size());
+
+    for (auto rate : rates)
+        stream.writeDouble(rate);
+
+    for (auto* parameter : parameters)
+        writeFixedString(stream, parameter->paramID);
+
+    for (const auto& preset : presets)
+    {
+        for (auto* parameter : parameters) //anything the preset doesn't mention is stored at its default
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+        preset.state.applyTo(scratch);
+
+        writeFixedString(stream, preset.name);
+        for (auto* parameter : parameters)
+            stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+
+        const auto settings = getChainSettings(scratch);
+        for (auto rate : rates)
+            writeChainCoefficients(stream, makeChainCoefficients(settings, rate));
+    }
+
+    return file.replaceWithData(stream.getData(), stream.getDataSize());
+}
+
+std::shared_ptr<const PresetBank> PresetBank::open(const juce::File& file)
+{
+    struct OpenBank
+    {
+        juce::File file;
+        juce::Time modified;
+        juce::int64 size;
+        std::weak_ptr<const PresetBank> bank; //the instances own it, the cache only remembers it
+    };
+    static juce::CriticalSection lock;
+    static std::vector<OpenBank> openBanks;
+
+    if (! file.existsAsFile())
+        return nullptr;
+
+    const auto modified = file.getLastModificationTime();
+    const auto size = file.getSize();
+    const juce::ScopedLock sl(lock);
+
+    for (const auto& entry : openBanks)
+        if (entry.file == file && entry.modified == modified && entry.size == size)
+            if (auto bank = entry.bank.lock())
+                return bank;
+
+    auto bank = std::make_shared<const PresetBank>(file);
+    if (! bank->isValid())
+        return nullptr;
+
+    openBanks.erase(std::remove_if(openBanks.begin(), openBanks.end(), [](const OpenBank& entry) { return entry.bank.expired(); }), openBanks.end());
+    openBanks.push_back({ file, modified, size, bank });
+    return bank;
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+               .getChildFile("SimpleEQ")
+               .getChildFile("Presets.seqbank");
+}
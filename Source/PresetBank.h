@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    A file of presets that is memory mapped rather than parsed. Every preset
+    is a fixed size record holding its name, its parameter values and its
+    coefficients pre-designed at the common sample rates, so finding preset n
+    is one multiply and switching to it needs no filter design at all.
+
+    Layout, little endian:
+        "SEQB" magic, uint16 format version, uint16 sample rate count,
+        int32 preset count, int32 parameter count, the sample rates as doubles,
+        the parameter IDs as 48 byte zero padded strings, then the records:
+        48 byte name, one float per parameter, one coefficient set per rate
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginState.h"
+
+class PresetBank
+{
+public:
+    static constexpr juce::uint32 magic = 0x42514553; //"SEQB" in little endian
+    static constexpr int formatVersion = 4, maxNumSampleRates = 8, nameSize = 48; //3: the coefficients carry their oversampling factor,
+                                                                                 //4: same records, parked cuts left in unless inaudible
+
+    explicit PresetBank(const juce::File& file); //maps the file, nothing is read up front
+    bool isValid() const noexcept { return numPresets > 0; }
+
+    int getNumPresets() const noexcept { return numPresets; }
+    juce::String getName(int index) const;
+    void applyValues(int index, juce::AudioProcessorValueTreeState& apvts) const;
+
+    /** Copies the preset's design for this rate, returns false if the bank wasn't made for it. */
+    bool getCoefficients(int index, double sampleRate, ChainCoefficients& result) const;
+
+    struct Preset
+    {
+        juce::String name;
+        PluginState state; //only the values are used, the coefficients are designed fresh for every rate in the bank
+    };
+
+    /** Designs every preset at every rate and writes the bank. scratch is put through each preset in turn, use a spare processor's. */
+    static bool write(const juce::File& file, const std::vector<Preset>& presets, juce::AudioProcessorValueTreeState& scratch,
+                      const std::vector<double>& sampleRates = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 });
+
+    static juce::File getDefaultFile(); //loaded by every instance when it exists
+
+    /** The bank in file, shared with every instance that opened it before unless the file has changed since.
+        nullptr if there's no valid bank there. A session of instances all opening the default bank maps it once.
+    */
+    static std::shared_ptr<const PresetBank> open(const juce::File& file);
+
+private:
+    const char* getRecord(int index) const noexcept { return data + recordsOffset + (size_t) index * recordSize; }
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const char* data{ nullptr };
+    int numPresets{ 0 }, numParameters{ 0 }, numSampleRates{ 0 };
+    bool hasCurrentDesigns{ false }; //a version 3 bank's values still load, its designs may skip a cut that should run
+    double sampleRates[maxNumSampleRates]{};
+    size_t parametersOffset{ 0 }, recordsOffset{ 0 }, recordSize{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
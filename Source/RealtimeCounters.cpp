@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    RealtimeCounters.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeCounters.h"
+
+namespace
+{
+    thread_local int callbackDepth = 0; //> 0 while this thread is inside processBlock
+    thread_local juce::int64 allocationsInCallback = 0;
+    std::atomic<int> countingScopes{ 0 };
+}
+
+void RealtimeCounters::countAllocation() noexcept
+{
+    if (callbackDepth > 0 && countingScopes.load(std::memory_order_relaxed) > 0)
+        ++allocationsInCallback;
+}
+
+bool RealtimeCounters::isCountingAllocations() noexcept
+{
+    return countingScopes.load(std::memory_order_relaxed) > 0;
+}
+
+RealtimeCounters::ScopedAllocationCounting::ScopedAllocationCounting() noexcept { countingScopes.fetch_add(1, std::memory_order_relaxed); }
+RealtimeCounters::ScopedAllocationCounting::~ScopedAllocationCounting() { countingScopes.fetch_sub(1, std::memory_order_relaxed); }
+
+RealtimeCounters::ScopedCallback::ScopedCallback(RealtimeCounters& c, int numSamples, double sampleRate) noexcept
+    : counters(c),
+      startTicks(juce::Time::getHighResolutionTicks()),
+      allocationsAtStart(allocationsInCallback),
+      blockSeconds(sampleRate > 0.0 ? numSamples / sampleRate : 0.0)
+{
+    ++callbackDepth;
+}
+
+RealtimeCounters::ScopedCallback::~ScopedCallback()
+{
+    --callbackDepth;
+    counters.callbacks.fetch_add(1, std::memory_order_relaxed);
+
+    if (const auto allocated = allocationsInCallback - allocationsAtStart; allocated > 0)
+        counters.allocations.fetch_add(allocated, std::memory_order_relaxed);
+
+    if (blockSeconds <= 0.0)
+        return;
+
+    const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    const auto load = seconds / blockSeconds;
+
+    for (auto worst = counters.worstCallbackLoad.load(std::memory_order_relaxed); load > worst;) //no fetch_max for doubles
+        if (counters.worstCallbackLoad.compare_exchange_weak(worst, load, std::memory_order_relaxed))
+            break;
+}
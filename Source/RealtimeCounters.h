@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    RealtimeCounters.h
+
+    Debug counters for the audio callback: how many callbacks ran, how many
+    heap allocations happened inside one, and the worst callback time as a
+    fraction of the block's duration.
+
+    Counting allocations needs a hook on the global operator new, and a
+    plugin that replaced it would take over allocation for its whole module,
+    host calls included. So the plugin never does: a harness that owns its
+    process (the benchmarks) replaces operator new itself, has it call
+    countAllocation(), and turns counting on with a ScopedAllocationCounting.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct RealtimeCounters
+{
+    std::atomic<juce::int64> callbacks{ 0 }, allocations{ 0 };
+    std::atomic<double> worstCallbackLoad{ 0.0 }; //1.0 means a callback took as long as the audio it produced
+
+    /** For the harness's operator new, counts the allocation if counting is on and this thread is inside a callback. */
+    static void countAllocation() noexcept;
+    static bool isCountingAllocations() noexcept; //false in a plugin, nothing there calls countAllocation()
+
+    /** Turns counting on for as long as it exists, create one only where operator new calls countAllocation(). */
+    struct ScopedAllocationCounting
+    {
+        ScopedAllocationCounting() noexcept;
+        ~ScopedAllocationCounting();
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedAllocationCounting)
+    };
+
+    /** Put one at the top of processBlock. Marks the thread as inside the callback until it goes out of scope. */
+    class ScopedCallback
+    {
+    public:
+        ScopedCallback(RealtimeCounters& counters, int numSamples, double sampleRate) noexcept;
+        ~ScopedCallback();
+
+    private:
+        RealtimeCounters& counters;
+        juce::int64 startTicks, allocationsAtStart;
+        double blockSeconds;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCallback)
+    };
+};
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+
+void ResponseCurve::update(const ChainCoefficients& coefficients, juce::Rectangle<float> bounds, double sampleRate)
+{
+    const auto numColumns = juce::jmax(2, juce::roundToInt(bounds.getWidth()));
+    const auto designRate = sampleRate * coefficients.oversamplingFactor; //the stages are evaluated at the rate they were designed for
+    if (numColumns != cachedColumns || designRate != cachedDesignRate)
+        updateFrequencies(numColumns, designRate);
+
+    cachedVersion = coefficients.version;
+    cachedBounds = bounds;
+    cachedSampleRate = sampleRate;
+    cachedDesignRate = designRate;
+    cachedColumns = numColumns;
+
+    std::fill(numerator.begin(), numerator.end(), Vector(1.0));
+    std::fill(denominator.begin(), denominator.end(), Vector(1.0));
+
+    for (int band = 0; band < maxNumBands; ++band)
+        if (coefficients.isBandActive(band))
+            multiplyStage(coefficients.bands.get(band));
+    for (int i = 0; i <= coefficients.lowCutSlope; ++i)
+        multiplyStage(coefficients.lowCut[(size_t) i]);
+    for (int i = 0; i <= coefficients.highCutSlope; ++i)
+        multiplyStage(coefficients.highCut[(size_t) i]);
+
+    const auto* numerators = reinterpret_cast<const double*>(numerator.data());
+    const auto* denominators = reinterpret_cast<const double*>(denominator.data());
+    const auto columnWidth = bounds.getWidth() / (float) (numColumns - 1);
+
+    path.clear();
+    path.preallocateSpace(3 * numColumns);
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const auto magnitudeSquared = numerators[column] / juce::jmax(denominators[column], 1.0e-300);
+        const auto decibels = (float) (10.0 * std::log10(juce::jmax(magnitudeSquared, 1.0e-12)));
+        const auto x = bounds.getX() + column * columnWidth;
+        const auto y = juce::jmap(juce::jlimit(minDecibels, maxDecibels, decibels), minDecibels, maxDecibels, bounds.getBottom(), bounds.getY());
+
+        if (column == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+}
+
+void ResponseCurve::updateFrequencies(int numColumns, double sampleRate)
+{
+    const auto numVectors = ((size_t) numColumns + lanes - 1) / lanes;
+    cosW.resize(numVectors);
+    cos2W.resize(numVectors);
+    numerator.resize(numVectors);
+    denominator.resize(numVectors);
+
+    auto* cosines = reinterpret_cast<double*>(cosW.data());
+    auto* doubleCosines = reinterpret_cast<double*>(cos2W.data());
+
+    for (size_t i = 0; i < numVectors * lanes; ++i) //the lanes past the last column just repeat it
+    {
+        const auto column = juce::jmin((int) i, numColumns - 1);
+        const auto frequency = juce::mapToLog10((double) column / (numColumns - 1), 20.0, 20000.0);
+        const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        cosines[i] = std::cos(w);
+        doubleCosines[i] = std::cos(2.0 * w);
+    }
+}
+
+void ResponseCurve::multiplyStage(const BiquadCoefficients& stage) noexcept
+{
+    const auto b0 = (double) stage[0], b1 = (double) stage[1], b2 = (double) stage[2];
+    const auto a1 = (double) stage[3], a2 = (double) stage[4];
+
+    const Vector n0(b0 * b0 + b1 * b1 + b2 * b2), n1(2.0 * (b0 * b1 + b1 * b2)), n2(2.0 * b0 * b2);
+    const Vector d0(1.0 + a1 * a1 + a2 * a2), d1(2.0 * (a1 + a1 * a2)), d2(2.0 * a2);
+
+    for (size_t i = 0; i < cosW.size(); ++i)
+    {
+        numerator[i] = numerator[i] * (n0 + n1 * cosW[i] + n2 * cos2W[i]);
+        denominator[i] = denominator[i] * (d0 + d1 * cosW[i] + d2 * cos2W[i]);
+    }
+}
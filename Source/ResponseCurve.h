@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+
+    The editor's EQ curve. All active biquads are evaluated for every pixel
+    column in one go, several columns per SIMD register, using
+
+        |B|^2 = b0^2 + b1^2 + b2^2 + 2(b0 b1 + b1 b2) cos w + 2 b0 b2 cos 2w
+        |A|^2 = 1 + a1^2 + a2^2 + 2(a1 + a1 a2) cos w + 2 a2 cos 2w
+
+    so no complex maths is needed per column. Numerators and denominators are
+    multiplied up separately (in double, a 48 dB/Oct cut underflows a float)
+    and divided once per column at the end. The finished path is cached on the
+    coefficient version and the bounds, repaints just stroke it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+class ResponseCurve
+{
+public:
+    static constexpr float minDecibels = -24.0f, maxDecibels = 24.0f;
+
+    bool isStale(juce::uint32 version, juce::Rectangle<float> bounds, double sampleRate) const noexcept
+    {
+        return version != cachedVersion || bounds != cachedBounds || sampleRate != cachedSampleRate;
+    }
+
+    /** Rebuilds the path. Only call when isStale() says so. */
+    void update(const ChainCoefficients& coefficients, juce::Rectangle<float> bounds, double sampleRate);
+
+    const juce::Path& getPath() const noexcept { return path; }
+
+private:
+   #if JUCE_USE_SIMD
+    using Vector = juce::dsp::SIMDRegister<double>;
+   #else
+    using Vector = double; //no SIMD on this target, one column at a time
+   #endif
+    static constexpr size_t lanes = sizeof(Vector) / sizeof(double);
+
+    void updateFrequencies(int numColumns, double sampleRate); //only when the width or rate changes
+    void multiplyStage(const BiquadCoefficients& stage) noexcept;
+
+    std::vector<Vector> cosW, cos2W, numerator, denominator; //one lane per pixel column
+    juce::Path path;
+
+    juce::uint32 cachedVersion{ 0 };
+    juce::Rectangle<float> cachedBounds;
+    double cachedSampleRate{ 0.0 };
+    double cachedDesignRate{ 0.0 }; //what the cosines were worked out for, the sample rate times the oversampling factor
+    int cachedColumns{ 0 };
+};
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer(AnalyzerFifo& preEQ, AnalyzerFifo& postEQ)
+    : juce::Thread("SimpleEQ Spectrum Analyzer"), preStream(preEQ), postStream(postEQ)
+{
+}
+
+void SpectrumAnalyzer::start()
+{
+    startThread();
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyzer::setBounds(juce::Rectangle<float> newBounds)
+{
+    const juce::ScopedLock sl(lock);
+    bounds = newBounds;
+    boundsChanged = true; //rebuild on the next frame even if no audio is coming in
+}
+
+bool SpectrumAnalyzer::getPaths(juce::Path& preEQ, juce::Path& postEQ)
+{
+    const juce::ScopedLock sl(lock);
+    if (! pathsChanged)
+        return false;
+
+    preEQ.swapWithPath(preEQPath);
+    postEQ.swapWithPath(postEQPath);
+    pathsChanged = false;
+    return true;
+}
+
+void SpectrumAnalyzer::run()
+{
+    constexpr double frameIntervalMs = 1000.0 / framesPerSecond;
+
+    while (! threadShouldExit())
+    {
+        const auto frameStart = juce::Time::getMillisecondCounterHiRes();
+        const auto hasNewAudio = analyse(preStream) | analyse(postStream); //both streams get drained either way
+
+        juce::Rectangle<float> area;
+        bool rebuild;
+        {
+            const juce::ScopedLock sl(lock);
+            area = bounds;
+            rebuild = hasNewAudio || boundsChanged;
+            boundsChanged = false;
+        }
+
+        if (rebuild && ! area.isEmpty())
+        {
+            const auto rate = sampleRate.load();
+            buildPath(preStream, area, rate);
+            buildPath(postStream, area, rate);
+
+            const juce::ScopedLock sl(lock);
+            preEQPath.swapWithPath(preStream.path);
+            postEQPath.swapWithPath(postStream.path);
+            pathsChanged = true;
+        }
+
+        const auto elapsed = juce::Time::getMillisecondCounterHiRes() - frameStart;
+        wait(juce::jmax(1, juce::roundToInt(frameIntervalMs - elapsed))); //the frame rate cap
+    }
+}
+
+bool SpectrumAnalyzer::analyse(Stream& stream)
+{
+    const auto numNew = stream.fifo.pull(incoming.data(), (int) incoming.size());
+    if (numNew == 0)
+        return false;
+
+    //slide the newest samples into the history window
+    auto& history = stream.history;
+    if (numNew >= fftSize)
+    {
+        std::copy(incoming.begin() + (numNew - fftSize), incoming.begin() + numNew, history.begin());
+    }
+    else
+    {
+        std::copy(history.begin() + numNew, history.end(), history.begin());
+        std::copy(incoming.begin(), incoming.begin() + numNew, history.end() - numNew);
+    }
+
+    std::copy(history.begin(), history.end(), fftData.begin());
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    //a full scale sine reads 0 dB: divide out the half spectrum and the Hann window's 0.5 coherent gain
+    constexpr auto scale = 4.0f / (float) fftSize;
+    constexpr auto releasePerFrame = 1.5f; //dB, peaks fall back slowly so the display doesn't flicker
+
+    for (size_t bin = 0; bin < stream.levels.size(); ++bin)
+    {
+        const auto level = juce::Decibels::gainToDecibels(fftData[bin] * scale, minDecibels);
+        stream.levels[bin] = juce::jmax(level, stream.levels[bin] - releasePerFrame);
+    }
+
+    return true;
+}
+
+void SpectrumAnalyzer::buildPath(Stream& stream, juce::Rectangle<float> area, double rate) const
+{
+    auto& path = stream.path;
+    path.clear();
+    path.preallocateSpace(3 * (int) stream.levels.size());
+
+    const auto toY = [area](float decibels)
+    {
+        return juce::jmap(juce::jlimit(minDecibels, maxDecibels, decibels), minDecibels, maxDecibels, area.getBottom(), area.getY());
+    };
+
+    const auto binWidth = rate / fftSize;
+    bool started = false;
+
+    for (size_t bin = 1; bin < stream.levels.size(); ++bin) //DC has no place on a log axis
+    {
+        const auto frequency = bin * binWidth;
+        if (frequency < 20.0)
+            continue;
+        if (frequency > 20000.0)
+            break;
+
+        const auto x = area.getX() + area.getWidth() * (float) juce::mapFromLog10(frequency, 20.0, 20000.0);
+        const auto y = toY(stream.levels[bin]);
+
+        if (started)
+            path.lineTo(x, y);
+        else
+            path.startNewSubPath(x, y);
+
+        started = true;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Turns the pre and post EQ sample streams into two spectrum paths. The FFTs
+    and the path building happen on the analyzer's own thread at a capped
+    frame rate, the editor only swaps the finished paths out and paints them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalyzerFifo.h"
+
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 11, fftSize = 1 << fftOrder;
+    static constexpr int framesPerSecond = 30;
+    static constexpr float minDecibels = -72.0f, maxDecibels = 12.0f;
+
+    SpectrumAnalyzer(AnalyzerFifo& preEQ, AnalyzerFifo& postEQ);
+    ~SpectrumAnalyzer() override;
+
+    void start(); //message thread, only once both FIFOs are allocated, the thread reads them from its first frame
+
+    void setBounds(juce::Rectangle<float> newBounds); //message thread, the paths are built to fit these
+    void setSampleRate(double newSampleRate) noexcept { sampleRate = newSampleRate; }
+
+    /** Message thread. Swaps the newest paths in and returns true if they changed since the last call. */
+    bool getPaths(juce::Path& preEQ, juce::Path& postEQ);
+
+private:
+    struct Stream
+    {
+        explicit Stream(AnalyzerFifo& source) : fifo(source) {}
+
+        AnalyzerFifo& fifo;
+        std::vector<float> history = std::vector<float>((size_t) fftSize, 0.0f); //the newest fftSize samples
+        std::vector<float> levels = std::vector<float>((size_t) fftSize / 2, minDecibels); //smoothed, in dB
+        juce::Path path;
+    };
+
+    void run() override;
+    bool analyse(Stream& stream); //returns true if there were new samples
+    void buildPath(Stream& stream, juce::Rectangle<float> area, double rate) const;
+
+    Stream preStream, postStream;
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::vector<float> incoming = std::vector<float>((size_t) AnalyzerFifo::capacity), fftData = std::vector<float>((size_t) fftSize * 2);
+    std::atomic<double> sampleRate{ 44100.0 };
+
+    juce::CriticalSection lock; //between the analyzer thread and the message thread only, the audio thread never sees it
+    juce::Rectangle<float> bounds;
+    bool boundsChanged{ false }, pathsChanged{ false };
+    juce::Path preEQPath, postEQPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
@@ -0,0 +1,235 @@
+/*
+  ==============================================================================
+
+    SvfChain.cpp
+
+  ==============================================================================
+*/
+
+#include "SvfChain.h"
+
+static double warp(double frequency, double sampleRate) noexcept
+{
+    //the bilinear transform's prewarp, kept off 0 and below Nyquist where tan turns around
+    return std::tan(juce::MathConstants<double>::pi * juce::jlimit(2.0, 0.49 * sampleRate, frequency) / sampleRate);
+}
+
+static SvfStage makeStage(double g, double k, double m0, double m1, double m2) noexcept
+{
+    return { (float) g, (float) k, (float) m0, (float) m1, (float) m2 };
+}
+
+static SvfStage makeBandStage(const BandSettings& band, double sampleRate) noexcept
+{
+    //A is the square root of the gain, as in the cookbook designs makeBandFilter uses
+    const auto a = std::sqrt((double) juce::Decibels::decibelsToGain(band.gainInDecibels));
+    const auto g = warp(band.freq, sampleRate);
+    const auto k = 1.0 / (double) band.quality;
+
+    switch (band.type)
+    {
+    case Band_LowShelf: //the shelf's corner sits at the geometric middle of the slope, the cutoff moves by the fourth root of the gain
+        return makeStage(g / std::sqrt(a), k, 1.0, k * (a - 1.0), a * a - 1.0);
+    case Band_HighShelf:
+        return makeStage(g * std::sqrt(a), k, a * a, k * (1.0 - a) * a, 1.0 - a * a);
+    case Band_Notch:
+        return makeStage(g, k, 1.0, -k, 0.0);
+    default: //a peak is the input plus some band pass, boosts and cuts get the same bandwidth by scaling the damping with the gain
+        return makeStage(g, k / a, 1.0, k / a * (a * a - 1.0), 0.0);
+    }
+}
+
+template <typename MakeStage>
+static void addCutStages(SvfStage* stages, float frequency, int slope, double sampleRate, MakeStage&& makeCutStage) noexcept
+{
+    //the same sections as JUCE's high order Butterworth designs: one biquad per 12 dB, all at the cutoff,
+    //with the damping of each pair of poles on the Butterworth circle
+    const auto g = warp(frequency, sampleRate);
+    const auto order = 2 * (slope + 1);
+    for (int i = 0; i <= slope; ++i)
+        stages[i] = makeCutStage(g, 2.0 * std::cos((2 * i + 1) * juce::MathConstants<double>::pi / (2 * order)));
+}
+
+SvfCoefficients makeSvfCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    SvfCoefficients coefficients;
+
+    if (! isLowCutOff(chainSettings, sampleRate))
+        addCutStages(coefficients.stages.data(), chainSettings.lowCutFreq, chainSettings.lowCutSlope, sampleRate,
+                     [](double g, double k) { return makeStage(g, k, 1.0, -k, -1.0); }); //high pass: what's left after the band and low pass
+
+    for (int i = 0; i < maxNumBands; ++i)
+        if (! isBandIdentity(chainSettings.bands[(size_t) i]))
+            coefficients.stages[(size_t) (SvfCoefficients::firstBand + i)] = makeBandStage(chainSettings.bands[(size_t) i], sampleRate);
+
+    if (! isHighCutOff(chainSettings, sampleRate))
+        addCutStages(coefficients.stages.data() + SvfCoefficients::firstHighCut, chainSettings.highCutFreq, chainSettings.highCutSlope, sampleRate,
+                     [](double g, double k) { return makeStage(g, k, 0.0, 0.0, 1.0); });
+
+    return coefficients;
+}
+
+//==============================================================================
+void SvfChain::prepare(double newSampleRate, int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+    states.assign((size_t) (numChannels * SvfCoefficients::numStages), State());
+    oversamplingFactor = 1;
+    numActiveStages = 0;
+    stepsRemaining = 0;
+    hasTarget = false;
+}
+
+void SvfChain::reset() noexcept
+{
+    std::fill(states.begin(), states.end(), State());
+    stepsRemaining = 0;
+    hasTarget = false;
+}
+
+void SvfChain::setOversamplingFactor(int factor) noexcept
+{
+    oversamplingFactor = factor;
+    reset();
+}
+
+void SvfChain::setTarget(const ChainSettings& newSettings, int rampLengthInSamples) noexcept
+{
+    if (hasTarget && newSettings == settings)
+        return;
+
+    settings = newSettings;
+    target = makeSvfCoefficients(settings, sampleRate * oversamplingFactor);
+    rampLengthInSamples *= oversamplingFactor;
+
+    if (! hasTarget || rampLengthInSamples <= 0)
+    {
+        hasTarget = true;
+        current = target.stages;
+        stepsRemaining = 0;
+    }
+    else
+    {
+        const auto steps = (float) rampLengthInSamples;
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            auto& from = current[i];
+            auto& to = target.stages[i];
+
+            //a stage that switches on or off keeps its cutoff and damping and only fades its mix in or out
+            if (from.isIdentity())
+                from.g = to.g, from.k = to.k;
+            else if (to.isIdentity())
+                to.g = from.g, to.k = from.k;
+
+            step[i] = { (to.g - from.g) / steps, (to.k - from.k) / steps, (to.m0 - from.m0) / steps, (to.m1 - from.m1) / steps, (to.m2 - from.m2) / steps };
+        }
+        stepsRemaining = rampLengthInSamples;
+    }
+
+    for (int i = 0; i < SvfCoefficients::numStages; ++i)
+        updateTick(i);
+    updateActiveStages();
+}
+
+void SvfChain::advance() noexcept
+{
+    if (--stepsRemaining == 0)
+    {
+        current = target.stages; //lands exactly, whatever the steps added up to
+        for (int n = 0; n < numActiveStages; ++n)
+            updateTick(activeStages[(size_t) n]);
+        updateActiveStages();
+        return;
+    }
+
+    for (int n = 0; n < numActiveStages; ++n)
+    {
+        const auto i = (size_t) activeStages[(size_t) n];
+        auto& stage = current[i];
+        const auto& delta = step[i];
+        stage.g += delta.g;
+        stage.k += delta.k;
+        stage.m0 += delta.m0;
+        stage.m1 += delta.m1;
+        stage.m2 += delta.m2;
+        updateTick((int) i);
+    }
+}
+
+void SvfChain::updateTick(int stage) noexcept
+{
+    const auto& parameters = current[(size_t) stage];
+    auto& tick = ticks[(size_t) stage];
+    tick.a1 = 1.f / (1.f + parameters.g * (parameters.g + parameters.k)); //the one division a parameter change costs
+    tick.a2 = parameters.g * tick.a1;
+    tick.a3 = parameters.g * tick.a2;
+}
+
+void SvfChain::updateActiveStages() noexcept
+{
+    numActiveStages = 0;
+    for (int i = 0; i < SvfCoefficients::numStages; ++i)
+    {
+        if (! current[(size_t) i].isIdentity() || ! target.stages[(size_t) i].isIdentity())
+        {
+            activeStages[(size_t) numActiveStages++] = i;
+            continue;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel) //a stage that has faded out starts from rest when it comes back
+            states[(size_t) (channel * SvfCoefficients::numStages + i)] = State();
+    }
+}
+
+float SvfChain::processSample(State* channelStates, float x) const noexcept
+{
+    for (int n = 0; n < numActiveStages; ++n)
+    {
+        const auto i = (size_t) activeStages[(size_t) n];
+        const auto& stage = current[i];
+        const auto& tick = ticks[i];
+        auto& state = channelStates[i];
+
+        const auto v3 = x - state.ic2;
+        const auto v1 = tick.a1 * state.ic1 + tick.a2 * v3; //band pass
+        const auto v2 = state.ic2 + tick.a2 * state.ic1 + tick.a3 * v3; //low pass
+        state.ic1 = 2.f * v1 - state.ic1;
+        state.ic2 = 2.f * v2 - state.ic2;
+        x = stage.m0 * x + stage.m1 * v1 + stage.m2 * v2;
+    }
+
+    return x;
+}
+
+void SvfChain::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    jassert((int) block.getNumChannels() <= numChannels); //prepare() sized the states for fewer channels
+    const auto channels = juce::jmin((int) block.getNumChannels(), numChannels);
+    const auto numSamples = block.getNumSamples();
+    size_t i = 0;
+
+    //while a ramp runs every sample has parameters of its own, shared by all the channels
+    for (; i < numSamples && stepsRemaining > 0; ++i)
+    {
+        advance();
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            auto* samples = block.getChannelPointer((size_t) channel);
+            samples[i] = processSample(states.data() + channel * SvfCoefficients::numStages, samples[i]);
+        }
+    }
+
+    if (numActiveStages == 0)
+        return;
+
+    //once it's done each channel runs through the rest of the block on its own
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        auto* samples = block.getChannelPointer((size_t) channel);
+        auto* channelStates = states.data() + channel * SvfCoefficients::numStages;
+        for (auto j = i; j < numSamples; ++j)
+            samples[j] = processSample(channelStates, samples[j]);
+    }
+}
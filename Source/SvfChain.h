@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    SvfChain.h
+
+    The LowCut / Bands / HighCut cascade built from topology-preserving
+    transform state variable filters (the trapezoidal SVF from Andrew
+    Simper's Cytomic notes) instead of direct form biquads.
+
+    A stage is the cutoff warped to g = tan(pi f / fs), a damping k and
+    three gains that mix the input, the band and the low pass outputs. The
+    mixes come from the same analog prototypes the RBJ cookbook and JUCE's
+    Butterworth sections bilinear-transform, so every stage has exactly the
+    response of the biquad it replaces. Unlike the biquad, whose states only
+    make sense for the coefficients they were built with, the SVF's states
+    are the integrators' charges, so g, k and the mixes can move every sample
+    without clicks or blowing up. The whole design is a tan and a couple of
+    multiplies per stage, cheap enough for the audio thread: automation is
+    ramped per sample instead of going through the coefficient service and
+    the 32 sample sub-blocks of the biquad smoother.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+struct SvfStage
+{
+    float g{ 0.f }, k{ 2.f }; //the defaults are an identity stage
+    float m0{ 1.f }, m1{ 0.f }, m2{ 0.f }; //output = m0 * input + m1 * band pass + m2 * low pass
+
+    bool isIdentity() const noexcept { return m0 == 1.f && m1 == 0.f && m2 == 0.f; }
+};
+
+struct SvfCoefficients // plain data like ChainCoefficients, in processing order
+{
+    static constexpr int numCutStages = 4, numStages = numCutStages + maxNumBands + numCutStages;
+    static constexpr int firstBand = numCutStages, firstHighCut = numCutStages + maxNumBands;
+    std::array<SvfStage, numStages> stages; //the stages the settings leave out stay identity so they can ramp in and out
+};
+
+/** Same stages as makeChainCoefficients, without a heap allocation or a lock. Real-time safe. */
+SvfCoefficients makeSvfCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept;
+
+class SvfChain
+{
+public:
+    void prepare(double sampleRate, int numChannels); //allocates the states, call from prepareToPlay only
+
+    /** Designs the settings if they changed since the last call and ramps to them per sample over rampLengthInSamples,
+        counted at the rate prepare() was given. The first set after prepare() or reset() is loaded straight away.
+    */
+    void setTarget(const ChainSettings& settings, int rampLengthInSamples) noexcept;
+
+    /** process() expects audio at the rate prepare() was given times this, 1 until it's set. The states hold samples
+        at the old rate, so they're cleared and the next target is jumped to.
+    */
+    void setOversamplingFactor(int factor) noexcept;
+    int getOversamplingFactor() const noexcept { return oversamplingFactor; }
+
+    void reset() noexcept; //clears the states, the next target is jumped to
+
+    bool isSmoothing() const noexcept { return stepsRemaining > 0; }
+
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+private:
+    struct State { float ic1{ 0.f }, ic2{ 0.f }; }; //the two integrators' charges
+    struct Tick { float a1, a2, a3; }; //g and k worked into the per sample update, redone only while g or k move
+
+    void advance() noexcept; //one sample further along the ramp
+    void updateTick(int stage) noexcept;
+    void updateActiveStages() noexcept;
+    float processSample(State* states, float x) const noexcept;
+
+    double sampleRate{ 44100.0 }; //before oversampling
+    int oversamplingFactor{ 1 };
+    ChainSettings settings; //what target was designed from
+    SvfCoefficients target;
+    std::array<SvfStage, SvfCoefficients::numStages> current, step;
+    std::array<Tick, SvfCoefficients::numStages> ticks;
+    std::array<int, SvfCoefficients::numStages> activeStages; //the stages that are or will be doing something, in order
+    int numActiveStages{ 0 };
+    int stepsRemaining{ 0 };
+    bool hasTarget{ false };
+
+    std::vector<State> states; //numStages per channel, channel major
+    int numChannels{ 0 };
+};
@@ -0,0 +1,299 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for the SimpleEQ stream host.
+
+    A headless real-time host that runs many independent SimpleEQ streams off
+    one driver clock, spread over pinned threads by a work-stealing pool.
+
+    Usage: SimpleEQStreamHost [--streams 300] [--samplerate 48000] [--period 256] [--channels 2]
+                              [--threads <cores>] [--no-pin]
+                              [--input in.wav] [--output monitor.wav] [--monitor <stream id>]
+                              [--seconds 10] [--freewheel] [--commands script.txt]
+           SimpleEQStreamHost --scaling [--streams 300] [--period 256] [--seconds 2]
+
+    Without --input the null driver feeds quiet noise. Once a second the host
+    prints the period load percentiles and the deadline misses. Commands,
+    one per line, come from stdin or the --commands file and run while the
+    audio keeps going:
+
+        add [count]                          starts new streams
+        remove <id>                          stops a stream
+        set <id|all> "<parameter ID>" <value>  e.g. set all "Peak Gain" 6
+        monitor <id>                         the stream --output records
+        stats                                prints the statistics now
+        sleep <seconds>                      pauses a command file
+        quit
+
+    --scaling freewheels the same streams with 1, 2, 4 ... threads and prints
+    the periods per second each manages.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "StreamHost.h"
+#include "StreamDriver.h"
+
+//==============================================================================
+/** Reads commands off the main thread, so a blocking stdin doesn't hold up the statistics. */
+class CommandReader : public juce::Thread
+{
+public:
+    explicit CommandReader(const juce::File& script) : juce::Thread("SimpleEQ Command Reader"), scriptFile(script) {}
+    ~CommandReader() override { stopThread(100); }
+
+    bool getNextCommand(juce::String& command)
+    {
+        const juce::ScopedLock sl(lock);
+        if (pending.isEmpty())
+            return false;
+
+        command = pending[0];
+        pending.remove(0);
+        return true;
+    }
+
+    bool isFinished() const noexcept { return finished; }
+
+private:
+    void run() override
+    {
+        if (scriptFile != juce::File())
+        {
+            juce::StringArray lines;
+            scriptFile.readLines(lines);
+            for (auto& line : lines)
+            {
+                if (threadShouldExit())
+                    break;
+
+                if (line.trim().startsWith("sleep")) //scripts are timed here so the main thread never stalls
+                    wait(juce::roundToInt(line.fromFirstOccurrenceOf("sleep", false, false).getDoubleValue() * 1000.0));
+                else
+                    add(line);
+            }
+        }
+        else
+        {
+            std::string line;
+            while (! threadShouldExit() && std::getline(std::cin, line)) //stdin closing ends the reader, not the host
+                add(line);
+        }
+
+        finished = true;
+    }
+
+    void add(const juce::String& line)
+    {
+        const juce::ScopedLock sl(lock);
+        pending.add(line.trim());
+    }
+
+    juce::File scriptFile;
+    juce::CriticalSection lock;
+    juce::StringArray pending;
+    std::atomic<bool> finished{ false };
+};
+
+//==============================================================================
+static void printStatistics(const StreamHost& host, const StreamDriver& driver)
+{
+    const auto statistics = host.getStatistics();
+    std::cout << "streams " << statistics.numStreams
+              << "  periods " << statistics.periods
+              << "  misses " << statistics.deadlineMisses
+              << "  late starts " << driver.getNumLateStarts()
+              << "  load p50 " << juce::String(statistics.loadP50 * 100.0, 1) << "%"
+              << " p99 " << juce::String(statistics.loadP99 * 100.0, 1) << "%"
+              << " max " << juce::String(statistics.loadMax * 100.0, 1) << "%"
+              << "  steals " << statistics.steals << std::endl;
+}
+
+/** Returns false for quit. */
+static bool runCommand(StreamHost& host, const StreamDriver& driver, const juce::String& command)
+{
+    juce::StringArray tokens;
+    tokens.addTokens(command, " \t", "\"");
+    tokens.trim();
+    tokens.removeEmptyStrings();
+    if (tokens.isEmpty() || tokens[0].startsWith("#"))
+        return true;
+
+    const auto& name = tokens[0];
+    if (name == "quit")
+        return false;
+
+    if (name == "add")
+    {
+        const auto count = tokens.size() > 1 ? juce::jmax(1, tokens[1].getIntValue()) : 1;
+        for (int i = 0; i < count; ++i)
+            host.addStream();
+        std::cout << "streams " << host.getNumStreams() << std::endl;
+    }
+    else if (name == "remove" && tokens.size() > 1)
+    {
+        if (! host.removeStream(tokens[1].getIntValue()))
+            std::cerr << "No stream " << tokens[1] << std::endl;
+    }
+    else if (name == "set" && tokens.size() > 3)
+    {
+        const auto id = tokens[1] == "all" ? -1 : tokens[1].getIntValue();
+        if (! host.setParameter(id, tokens[2].unquoted(), tokens[3].getFloatValue()))
+            std::cerr << "Nothing matched " << command << std::endl;
+    }
+    else if (name == "monitor" && tokens.size() > 1)
+    {
+        host.setMonitoredStream(tokens[1].getIntValue());
+    }
+    else if (name == "stats")
+    {
+        printStatistics(host, driver);
+    }
+    else
+    {
+        std::cerr << "Unknown command " << command << std::endl;
+    }
+
+    return true;
+}
+
+//==============================================================================
+static StreamHost::Options readOptions(const juce::ArgumentList& args)
+{
+    StreamHost::Options options;
+    if (args.containsOption("--samplerate"))
+        options.sampleRate = juce::jmax(8000.0, args.getValueForOption("--samplerate").getDoubleValue());
+    if (args.containsOption("--period"))
+        options.periodSize = juce::jlimit(16, 8192, args.getValueForOption("--period").getIntValue());
+    if (args.containsOption("--channels"))
+        options.numChannels = juce::jlimit(1, SimpleEQAudioProcessor::maxNumChannels, args.getValueForOption("--channels").getIntValue());
+    if (args.containsOption("--threads"))
+        options.numThreads = juce::jmax(1, args.getValueForOption("--threads").getIntValue());
+    options.pinThreads = ! args.containsOption("--no-pin");
+    return options;
+}
+
+static int getNumStreams(const juce::ArgumentList& args)
+{
+    return args.containsOption("--streams") ? juce::jmax(0, args.getValueForOption("--streams").getIntValue()) : 300;
+}
+
+/** Freewheels the same streams on more and more threads, the periods per second should grow with the threads. */
+static int runScaling(const juce::ArgumentList& args)
+{
+    const auto numStreams = getNumStreams(args);
+    const auto seconds = args.containsOption("--seconds") ? juce::jmax(0.5, args.getValueForOption("--seconds").getDoubleValue()) : 2.0;
+    auto options = readOptions(args);
+    const auto maxThreads = juce::SystemStats::getNumCpus();
+
+    std::cout << numStreams << " streams, " << options.periodSize << " sample periods at " << options.sampleRate << " Hz" << std::endl
+              << "threads   periods/s   realtime x   speedup" << std::endl;
+
+    double singleThreaded = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? juce::jmin(maxThreads, threads * 2) : threads + 1)
+    {
+        options.numThreads = threads;
+        StreamHost host(options);
+        for (int i = 0; i < numStreams; ++i)
+            host.addStream();
+
+        NullDriver driver(host);
+        driver.setFreewheel(true);
+        driver.start();
+        juce::Thread::sleep(200); //lets the designs land and the caches warm up
+        host.resetStatistics();
+        juce::Thread::sleep(juce::roundToInt(seconds * 1000.0));
+        const auto periodsPerSecond = (double) host.getStatistics().periods / seconds;
+        driver.stop();
+
+        if (threads == 1)
+            singleThreaded = periodsPerSecond;
+
+        const auto realtime = periodsPerSecond * options.periodSize / options.sampleRate;
+        std::cout << juce::String(threads).paddedLeft(' ', 7)
+                  << juce::String(periodsPerSecond, 0).paddedLeft(' ', 12)
+                  << juce::String(realtime, 2).paddedLeft(' ', 13)
+                  << juce::String(periodsPerSecond / juce::jmax(1.0, singleThreaded), 2).paddedLeft(' ', 10) << std::endl;
+    }
+
+    return 0;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; //the APVTS needs a message manager, no window is ever opened
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help"))
+    {
+        std::cout << "Usage: SimpleEQStreamHost [--streams 300] [--samplerate 48000] [--period 256] [--threads <n>] [--no-pin]" << std::endl
+                  << "                          [--input in.wav] [--output monitor.wav] [--seconds 10] [--freewheel] [--commands script.txt]" << std::endl
+                  << "       SimpleEQStreamHost --scaling [--streams 300] [--period 256] [--seconds 2]" << std::endl;
+        return 0;
+    }
+
+    if (args.containsOption ("--scaling"))
+        return runScaling (args);
+
+    StreamHost host (readOptions (args));
+    const auto numStreams = getNumStreams (args);
+    for (int i = 0; i < numStreams; ++i)
+        host.addStream();
+
+    std::unique_ptr<StreamDriver> driver;
+    if (args.containsOption ("--input"))
+    {
+        auto fileDriver = std::make_unique<FileDriver> (host, args.getExistingFileForOption ("--input"),
+                                                        args.containsOption ("--output") ? args.getFileForOption ("--output") : juce::File());
+        if (! fileDriver->isValid())
+        {
+            std::cerr << "Couldn't read " << args.getValueForOption ("--input") << std::endl;
+            return 1;
+        }
+        driver = std::move (fileDriver);
+    }
+    else
+    {
+        driver = std::make_unique<NullDriver> (host);
+    }
+
+    if (args.containsOption ("--monitor"))
+        host.setMonitoredStream (args.getValueForOption ("--monitor").getIntValue());
+
+    driver->setFreewheel (args.containsOption ("--freewheel"));
+    driver->start();
+
+    CommandReader commands (args.containsOption ("--commands") ? args.getExistingFileForOption ("--commands") : juce::File());
+    commands.startThread();
+
+    const auto seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue() : 0.0; //0 runs until quit
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    auto lastReport = start;
+
+    for (bool running = true; running;)
+    {
+        juce::String command;
+        while (running && commands.getNextCommand (command))
+            running = runCommand (host, *driver, command);
+
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        if (now - lastReport >= 1000.0)
+        {
+            printStatistics (host, *driver);
+            host.collectGarbage(); //streams removed while the driver was mid period
+            lastReport = now;
+        }
+
+        if (seconds > 0.0 && now - start >= seconds * 1000.0)
+            break;
+
+        juce::Thread::sleep (20);
+    }
+
+    driver->stop();
+    printStatistics (host, *driver);
+
+    const auto statistics = host.getStatistics();
+    return statistics.deadlineMisses > 0 ? 2 : 0;
+}
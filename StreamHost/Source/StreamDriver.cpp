@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    StreamDriver.cpp
+
+  ==============================================================================
+*/
+
+#include "StreamDriver.h"
+#include <chrono>
+#include <thread>
+
+StreamDriver::StreamDriver(StreamHost& h, const juce::String& name)
+    : juce::Thread(name), host(h)
+{
+    const auto& options = host.getOptions();
+    input.setSize(options.numChannels, options.periodSize);
+    output.setSize(options.numChannels, options.periodSize);
+    input.clear();
+}
+
+StreamDriver::~StreamDriver()
+{
+    stop();
+}
+
+void StreamDriver::start()
+{
+    startRealtimeThread(juce::Thread::RealtimeOptions{});
+}
+
+void StreamDriver::stop()
+{
+    stopThread(2000);
+}
+
+void StreamDriver::run()
+{
+    const auto& options = host.getOptions();
+    if (options.pinThreads)
+        WorkStealingPool::pinCurrentThread(options.firstCore); //the pool's workers are on the cores after this one
+
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.periodSize / options.sampleRate));
+    auto* monitorOutput = wantsOutput() ? &output : nullptr;
+    auto nextPeriod = Clock::now();
+
+    while (! threadShouldExit())
+    {
+        fillInput(input);
+        host.processPeriod(input, monitorOutput);
+        if (monitorOutput != nullptr)
+            handleOutput(output);
+
+        if (freewheel.load(std::memory_order_relaxed))
+            continue;
+
+        //the clock runs on regardless of how long processing took, like a device's
+        nextPeriod += period;
+        const auto now = Clock::now();
+        if (now < nextPeriod)
+        {
+            std::this_thread::sleep_until(nextPeriod);
+        }
+        else
+        {
+            lateStarts.store(lateStarts.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            nextPeriod = now; //a device would have dropped the period, don't try to catch up on it
+        }
+    }
+}
+
+//==============================================================================
+void NullDriver::fillInput(juce::AudioBuffer<float>& buffer) noexcept
+{
+    //-60 dB noise, loud enough that no stream ever goes idle and skips its work
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(channel, i, (random.nextFloat() * 2.f - 1.f) * 0.001f);
+}
+
+//==============================================================================
+FileDriver::FileDriver(StreamHost& h, const juce::File& inputFile, const juce::File& outputFile)
+    : StreamDriver(h, "SimpleEQ File Driver")
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    if (std::unique_ptr<juce::AudioFormatReader> reader { formats.createReaderFor(inputFile) })
+    {
+        source.setSize((int) reader->numChannels, (int) juce::jmin(reader->lengthInSamples, (juce::int64) std::numeric_limits<int>::max()));
+        reader->read(&source, 0, source.getNumSamples(), 0, true, true);
+    }
+
+    if (outputFile == juce::File())
+        return;
+
+    const auto& options = host.getOptions();
+    outputFile.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream = std::make_unique<juce::FileOutputStream>(outputFile);
+    std::unique_ptr<juce::AudioFormatWriter> fileWriter(juce::WavAudioFormat().createWriterFor(stream.get(), options.sampleRate,
+                                                                                              (unsigned int) options.numChannels, 24, {}, 0));
+    if (fileWriter == nullptr)
+        return;
+
+    stream.release(); //the writer owns it now
+    writerThread.startThread();
+    writer = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(fileWriter.release(), writerThread, options.sampleRate);
+}
+
+FileDriver::~FileDriver()
+{
+    stop();
+    writer.reset(); //flushes what is left in the FIFO
+    writerThread.stopThread(2000);
+}
+
+void FileDriver::fillInput(juce::AudioBuffer<float>& buffer) noexcept
+{
+    if (! isValid())
+        return; //stays silent
+
+    for (int done = 0; done < buffer.getNumSamples();)
+    {
+        const auto count = juce::jmin(buffer.getNumSamples() - done, source.getNumSamples() - position);
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel) //mono files feed every channel
+            buffer.copyFrom(channel, done, source, channel % source.getNumChannels(), position, count);
+
+        done += count;
+        position = (position + count) % source.getNumSamples();
+    }
+}
+
+void FileDriver::handleOutput(const juce::AudioBuffer<float>& buffer) noexcept
+{
+    //drops the period if the writer thread has fallen behind rather than blocking the clock
+    writer->write(buffer.getArrayOfReadPointers(), buffer.getNumSamples());
+}
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    StreamDriver.h
+
+    Stand-ins for an audio device: a pinned real-time thread that calls
+    StreamHost::processPeriod once per period, paced by the steady clock as
+    a sound card's interrupt would be, or back to back when freewheeling to
+    find the most periods a second the box can do.
+
+    NullDriver feeds quiet noise and throws the output away. FileDriver
+    loops an audio file as the input of every stream and can write one
+    stream's output to a wav file.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StreamHost.h"
+
+class StreamDriver : private juce::Thread
+{
+public:
+    ~StreamDriver() override; //derived drivers stop in their own destructor, while their fillInput still exists
+
+    void start();
+    void stop();
+
+    /** Without a clock the driver runs period after period as fast as the host can, deadlines are still counted. */
+    void setFreewheel(bool shouldFreewheel) noexcept { freewheel = shouldFreewheel; }
+
+    /** Periods the driver was late to start because the previous one overran. */
+    juce::uint64 getNumLateStarts() const noexcept { return lateStarts.load(std::memory_order_relaxed); }
+
+protected:
+    StreamDriver(StreamHost& host, const juce::String& name);
+
+    /** Fills the next period's input, driver thread. */
+    virtual void fillInput(juce::AudioBuffer<float>& input) noexcept = 0;
+
+    /** Gets the monitored stream's output, driver thread. Only called when wantsOutput() said so when the driver started. */
+    virtual void handleOutput(const juce::AudioBuffer<float>&) noexcept {}
+    virtual bool wantsOutput() const { return false; }
+
+    StreamHost& host;
+
+private:
+    void run() override;
+
+    juce::AudioBuffer<float> input, output;
+    std::atomic<bool> freewheel{ false };
+    std::atomic<juce::uint64> lateStarts{ 0 };
+};
+
+//==============================================================================
+class NullDriver : public StreamDriver
+{
+public:
+    explicit NullDriver(StreamHost& host) : StreamDriver(host, "SimpleEQ Null Driver") {}
+    ~NullDriver() override { stop(); }
+
+private:
+    void fillInput(juce::AudioBuffer<float>& input) noexcept override;
+
+    juce::Random random;
+};
+
+//==============================================================================
+class FileDriver : public StreamDriver
+{
+public:
+    /** Reads the whole input file up front. outputFile may be a default File for no output. */
+    FileDriver(StreamHost& host, const juce::File& inputFile, const juce::File& outputFile);
+    ~FileDriver() override;
+
+    bool isValid() const noexcept { return source.getNumSamples() > 0; }
+
+private:
+    void fillInput(juce::AudioBuffer<float>& input) noexcept override;
+    void handleOutput(const juce::AudioBuffer<float>& output) noexcept override;
+    bool wantsOutput() const override { return writer != nullptr; }
+
+    juce::AudioBuffer<float> source; //played in a loop
+    int position{ 0 };
+
+    juce::TimeSliceThread writerThread{ "SimpleEQ Stream Writer" };
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer; //file IO happens on writerThread, never on the driver
+};
@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    StreamHost.cpp
+
+  ==============================================================================
+*/
+
+#include "StreamHost.h"
+
+StreamHost::StreamHost(const Options& o)
+    : options(o), pool(o.numThreads, o.pinThreads, o.firstCore)
+{
+    const juce::ScopedLock sl(controlLock);
+    publish(std::make_unique<StreamSet>());
+}
+
+StreamHost::~StreamHost()
+{
+    //the driver must have stopped by now
+    jassert(inUse.load() == nullptr);
+
+    for (auto& stream : streams)
+        stream->processor->releaseResources();
+}
+
+//==============================================================================
+int StreamHost::addStream()
+{
+    auto stream = std::make_unique<Stream>();
+    stream->processor = std::make_unique<SimpleEQAudioProcessor>();
+    auto& processor = *stream->processor;
+    processor.setParallelChannelThreshold(SimpleEQAudioProcessor::maxNumChannels + 1); //the streams are already spread over the cores
+    processor.getPerformanceMonitor().setEnabled(false); //the host times whole periods
+
+    const auto layout = options.numChannels == 1 ? juce::AudioChannelSet::mono()
+                      : options.numChannels == 2 ? juce::AudioChannelSet::stereo()
+                                                 : juce::AudioChannelSet::discreteChannels(options.numChannels);
+    auto buses = processor.getBusesLayout(); //only the main buses change, the sidechain stays off
+    buses.inputBuses.getReference(0) = layout;
+    buses.outputBuses.getReference(0) = layout;
+    if (! processor.setBusesLayout(buses))
+        return -1;
+
+    //prepared before the driver can see it, so the first period it takes part in is an ordinary one
+    processor.setRateAndBufferSizeDetails(options.sampleRate, options.periodSize);
+    processor.prepareToPlay(options.sampleRate, options.periodSize);
+    stream->buffer.setSize(options.numChannels, options.periodSize);
+    stream->midi.ensureSize(256);
+
+    const juce::ScopedLock sl(controlLock);
+    stream->id = nextStreamId++;
+
+    auto next = std::make_unique<StreamSet>(*currentSet);
+    next->streams.push_back(stream.get());
+    streams.push_back(std::move(stream));
+
+    publish(std::move(next));
+    return streams.back()->id;
+}
+
+bool StreamHost::removeStream(int id)
+{
+    const juce::ScopedLock sl(controlLock);
+
+    auto found = std::find_if(streams.begin(), streams.end(), [id](const auto& s) { return s->id == id; });
+    if (found == streams.end())
+        return false;
+
+    auto next = std::make_unique<StreamSet>(*currentSet);
+    next->streams.erase(std::find(next->streams.begin(), next->streams.end(), found->get()));
+
+    retiredStreams.push_back(std::move(*found)); //the driver may still be running it, freed with the set it was in
+    streams.erase(found);
+
+    publish(std::move(next));
+    return true;
+}
+
+int StreamHost::getNumStreams() const
+{
+    const juce::ScopedLock sl(controlLock);
+    return (int) streams.size();
+}
+
+juce::Array<int> StreamHost::getStreamIds() const
+{
+    const juce::ScopedLock sl(controlLock);
+
+    juce::Array<int> ids;
+    for (auto& stream : streams)
+        ids.add(stream->id);
+    return ids;
+}
+
+bool StreamHost::setParameter(int id, const juce::String& parameterID, float value)
+{
+    const juce::ScopedLock sl(controlLock);
+    bool matched = false;
+
+    for (auto& stream : streams)
+    {
+        if (id >= 0 && stream->id != id)
+            continue;
+
+        //the same path a host's automation takes, the stream's design thread picks it up without disturbing the driver
+        if (auto* parameter = stream->processor->apvts.getParameter(parameterID))
+        {
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            matched = true;
+        }
+    }
+
+    return matched;
+}
+
+void StreamHost::publish(std::unique_ptr<StreamSet> next)
+{
+    auto* previous = currentSet.get();
+    current.store(next.get()); //seq_cst, see collectGarbage
+    if (previous != nullptr)
+        retiredSets.push_back(std::move(currentSet));
+    currentSet = std::move(next);
+
+    collectGarbage();
+}
+
+void StreamHost::collectGarbage()
+{
+    const juce::ScopedLock sl(controlLock);
+
+    //current no longer points at any retired set, so once the driver isn't announcing one of them it never will again
+    auto* announced = inUse.load();
+    for (auto& set : retiredSets)
+        if (set.get() == announced)
+            return;
+
+    for (auto& stream : retiredStreams)
+        stream->processor->releaseResources();
+
+    retiredSets.clear();
+    retiredStreams.clear(); //frees the processors here, never on the driver thread
+}
+
+//==============================================================================
+void StreamHost::processStream(void* context, int index) noexcept
+{
+    const auto& periodJob = *static_cast<const PeriodJob*>(context);
+    auto& stream = *periodJob.set->streams[(size_t) index];
+    const auto& input = *periodJob.input;
+
+    for (int channel = 0; channel < stream.buffer.getNumChannels(); ++channel) //mono input feeds every channel
+        stream.buffer.copyFrom(channel, 0, input, channel % input.getNumChannels(), 0, stream.buffer.getNumSamples());
+
+    stream.processor->processBlock(stream.buffer, stream.midi);
+}
+
+void StreamHost::processPeriod(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>* monitorOutput) noexcept
+{
+    jassert(input.getNumSamples() == options.periodSize);
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    //announce the set before using it, and check it is still current so collectGarbage can't have missed the announcement
+    StreamSet* set = nullptr;
+    do
+    {
+        set = current.load();
+        inUse.store(set);
+    }
+    while (set != current.load());
+
+    job.set = set;
+    job.input = &input;
+    pool.run(processStream, &job, (int) set->streams.size());
+
+    if (monitorOutput != nullptr)
+    {
+        monitorOutput->clear();
+        const auto id = monitoredStream.load(std::memory_order_relaxed);
+
+        for (auto* stream : set->streams)
+        {
+            if (stream->id != id && ! (id < 0 && stream == set->streams.front()))
+                continue;
+
+            for (int channel = 0; channel < juce::jmin(monitorOutput->getNumChannels(), stream->buffer.getNumChannels()); ++channel)
+                monitorOutput->copyFrom(channel, 0, stream->buffer, channel, 0, juce::jmin(monitorOutput->getNumSamples(), stream->buffer.getNumSamples()));
+            break;
+        }
+    }
+
+    inUse.store(nullptr);
+
+    const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    const auto load = seconds * options.sampleRate / options.periodSize;
+    loads.add((juce::uint32) juce::jmin(load * 1.0e6, (double) std::numeric_limits<juce::uint32>::max()));
+
+    if (load > 1.0) //past the next period's start, a real device would have played a gap
+        deadlineMisses.store(deadlineMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    periods.store(periods.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+StreamHost::Statistics StreamHost::getStatistics() const
+{
+    Statistics statistics;
+    statistics.periods = periods.load(std::memory_order_relaxed);
+    statistics.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+    statistics.steals = pool.getNumSteals() - stealsAtReset.load(std::memory_order_relaxed);
+    statistics.loadP50 = loads.getPercentile(0.5) * 1.0e-6;
+    statistics.loadP99 = loads.getPercentile(0.99) * 1.0e-6;
+    statistics.loadMax = loads.getMax() * 1.0e-6;
+    statistics.numStreams = getNumStreams();
+    return statistics;
+}
+
+void StreamHost::resetStatistics() noexcept
+{
+    periods = 0;
+    deadlineMisses = 0;
+    stealsAtReset = pool.getNumSteals();
+    loads.reset();
+}
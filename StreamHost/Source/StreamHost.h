@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    StreamHost.h
+
+    Owns many independent SimpleEQAudioProcessor instances, one per stream,
+    and runs all of them once per period of a single driver clock. The
+    streams of a period are spread over a WorkStealingPool.
+
+    The driver thread only ever sees an immutable StreamSet. Adding or
+    removing a stream builds a new set on the control thread and swaps it
+    in, the old set (and any stream that left with it) is freed by the
+    control thread once the driver is provably done with it, so the audio
+    never stops and the driver never allocates or frees.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "WorkStealingPool.h"
+
+class StreamHost
+{
+public:
+    struct Options
+    {
+        double sampleRate{ 48000.0 };
+        int periodSize{ 256 };
+        int numChannels{ 2 };
+        int numThreads{ juce::SystemStats::getNumCpus() }; //the driver thread counts as one
+        bool pinThreads{ true };
+        int firstCore{ 0 }; //the driver is pinned here, workers to the cores after it
+    };
+
+    explicit StreamHost(const Options& options);
+    ~StreamHost();
+
+    const Options& getOptions() const noexcept { return options; }
+
+    //==============================================================================
+    //control thread, any time, the driver keeps running
+
+    /** Creates, prepares and publishes a stream. Returns its id. */
+    int addStream();
+    bool removeStream(int id);
+    int getNumStreams() const;
+    juce::Array<int> getStreamIds() const;
+
+    /** Sets a parameter in real world units on one stream, or on all of them for id -1. Returns false if nothing matched. */
+    bool setParameter(int id, const juce::String& parameterID, float value);
+
+    /** Frees the sets and streams the driver has moved past. add/remove call it, a periodic call keeps memory down. */
+    void collectGarbage();
+
+    //==============================================================================
+    /** Driver thread, once per period: copies input into every stream, processes them all and copies the monitored stream
+        to monitorOutput if given. Real-time safe.
+    */
+    void processPeriod(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>* monitorOutput) noexcept;
+
+    void setMonitoredStream(int id) noexcept { monitoredStream = id; }
+
+    struct Statistics
+    {
+        juce::uint64 periods{ 0 }, deadlineMisses{ 0 }, steals{ 0 };
+        double loadP50{ 0.0 }, loadP99{ 0.0 }, loadMax{ 0.0 }; //proportion of the period spent processing
+        int numStreams{ 0 };
+    };
+
+    Statistics getStatistics() const;
+    void resetStatistics() noexcept; //the counts may be off by a period if the driver is running
+
+private:
+    struct Stream
+    {
+        int id{ 0 };
+        std::unique_ptr<SimpleEQAudioProcessor> processor;
+        juce::AudioBuffer<float> buffer; //sized for a period, the processor works in place
+        juce::MidiBuffer midi;
+    };
+
+    struct StreamSet
+    {
+        std::vector<Stream*> streams; //never changes once published
+    };
+
+    struct PeriodJob //what the pool's tasks see
+    {
+        const StreamSet* set{ nullptr };
+        const juce::AudioBuffer<float>* input{ nullptr };
+    };
+
+    static void processStream(void* context, int index) noexcept;
+    void publish(std::unique_ptr<StreamSet> next); //control thread, under controlLock
+
+    const Options options;
+    WorkStealingPool pool;
+    PeriodJob job;
+
+    //the driver announces the set it is using in inUse before it touches it, the control thread only frees a set nobody announced
+    std::atomic<StreamSet*> current{ nullptr };
+    std::atomic<StreamSet*> inUse{ nullptr };
+
+    juce::CriticalSection controlLock; //between control threads only, the driver never takes it
+    std::unique_ptr<StreamSet> currentSet;
+    std::vector<std::unique_ptr<StreamSet>> retiredSets;
+    std::vector<std::unique_ptr<Stream>> streams, retiredStreams;
+    int nextStreamId{ 0 };
+
+    std::atomic<int> monitoredStream{ -1 };
+    std::atomic<juce::uint64> periods{ 0 }, deadlineMisses{ 0 }, stealsAtReset{ 0 };
+    LogHistogram loads; //parts per million of the period, the driver is the only writer
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamHost)
+};
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    WorkStealingPool.cpp
+
+  ==============================================================================
+*/
+
+#include "WorkStealingPool.h"
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+class WorkStealingPool::Worker : public juce::Thread
+{
+public:
+    Worker(WorkStealingPool& p, int participantIndex, int c)
+        : juce::Thread("SimpleEQ Stream Worker " + juce::String(participantIndex)), pool(p), participant(participantIndex), core(c) {}
+    ~Worker() override { stopThread(1000); }
+
+    /** Called by run() after a new job was published. Only signals a worker that has actually gone to sleep. */
+    void wakeIfSleeping() noexcept
+    {
+        if (sleeping.load()) //seq_cst, pairs with the store + generation check in run()
+            wakeUp.signal();
+    }
+
+    void run() override
+    {
+        if (core >= 0)
+            pinCurrentThread(core);
+
+        juce::uint32 seen = pool.generation.load(std::memory_order_acquire);
+        auto lastWork = juce::Time::getMillisecondCounter();
+
+        while (! threadShouldExit())
+        {
+            const auto current = pool.generation.load(std::memory_order_acquire);
+            const auto now = juce::Time::getMillisecondCounter();
+
+            if (current != seen)
+            {
+                seen = current;
+                pool.work(participant, current);
+                lastWork = now;
+            }
+            else if (now - lastWork < spinTimeoutMs)
+            {
+                juce::Thread::yield(); //the next period is only a few ms away
+            }
+            else
+            {
+                //the driver stopped, sleep until it publishes again rather than burning the core
+                sleeping.store(true);
+                if (pool.generation.load() == seen)
+                    wakeUp.wait(10);
+                sleeping.store(false);
+            }
+        }
+    }
+
+private:
+    static constexpr juce::uint32 spinTimeoutMs = 100;
+    WorkStealingPool& pool;
+    const int participant, core;
+    std::atomic<bool> sleeping{ false };
+    juce::WaitableEvent wakeUp;
+};
+
+//==============================================================================
+static constexpr juce::uint64 indexMask = 0xffff;
+
+static juce::uint64 makeShareState(juce::uint32 generation, juce::uint64 end, juce::uint64 next) noexcept
+{
+    return ((juce::uint64) generation << 32) | (end << 16) | next;
+}
+
+WorkStealingPool::WorkStealingPool(int numThreads, bool pinThreads, int firstCore)
+    : numParticipants(juce::jmax(1, numThreads)), shares(new Share[(size_t) juce::jmax(1, numThreads)])
+{
+    for (int i = 1; i < numParticipants; ++i) //participant 0 is whoever calls run()
+    {
+        auto* worker = workers.add(new Worker(*this, i, pinThreads ? firstCore + i : -1));
+        worker->startRealtimeThread(juce::Thread::RealtimeOptions{}); //same scheduling class as the driver
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    workers.clear(); //each Worker's destructor stops its thread
+}
+
+bool WorkStealingPool::pinCurrentThread(int core)
+{
+   #if JUCE_LINUX
+    //juce::Thread's affinity mask is 32 bits wide, big boxes have more cores than that
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core % juce::SystemStats::getNumCpus(), &cores);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) == 0;
+   #else
+    if (! juce::isPositiveAndBelow(core, 32))
+        return false;
+
+    juce::Thread::setCurrentThreadAffinityMask((juce::uint32) 1 << core);
+    return true;
+   #endif
+}
+
+void WorkStealingPool::run(Task task, void* context, int numTasks) noexcept
+{
+    jassert(numTasks >= 0 && (juce::uint64) numTasks <= indexMask);
+
+    //the previous job has fully finished, so nobody can be reading these now
+    currentTask.store(task, std::memory_order_relaxed);
+    currentContext.store(context, std::memory_order_relaxed);
+    tasksFinished.store(0, std::memory_order_relaxed);
+
+    //contiguous shares keep neighbouring streams on one core from period to period
+    const auto jobGeneration = generation.load(std::memory_order_relaxed) + 1;
+    for (int i = 0; i < numParticipants; ++i)
+    {
+        const auto begin = (juce::uint64) (numTasks * (juce::int64) i / numParticipants);
+        const auto end = (juce::uint64) (numTasks * (juce::int64) (i + 1) / numParticipants);
+        shares[(size_t) i].state.store(makeShareState(jobGeneration, end, begin), std::memory_order_relaxed);
+    }
+
+    generation.store(jobGeneration); //seq_cst, releases the shares and pairs with the workers' sleeping flag
+
+    for (auto* worker : workers)
+        worker->wakeIfSleeping();
+
+    work(0, jobGeneration);
+
+    while (tasksFinished.load(std::memory_order_acquire) < numTasks) //only waits on tasks a worker is already running
+        juce::Thread::yield();
+}
+
+void WorkStealingPool::work(int participant, juce::uint32 jobGeneration) noexcept
+{
+    int taskIndex = 0;
+
+    while (claimFront(shares[(size_t) participant], jobGeneration, taskIndex))
+        runTask(taskIndex);
+
+    juce::uint64 stolen = 0;
+    for (int offset = 1; offset < numParticipants; ++offset) //start with the next one along so thieves spread out
+    {
+        auto& victim = shares[(size_t) ((participant + offset) % numParticipants)];
+        while (claimBack(victim, jobGeneration, taskIndex))
+        {
+            runTask(taskIndex);
+            ++stolen;
+        }
+    }
+
+    if (stolen > 0)
+        steals.fetch_add(stolen, std::memory_order_relaxed);
+}
+
+bool WorkStealingPool::claimFront(Share& share, juce::uint32 jobGeneration, int& taskIndex) noexcept
+{
+    auto state = share.state.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto next = state & indexMask;
+        if ((juce::uint32) (state >> 32) != jobGeneration || next >= ((state >> 16) & indexMask))
+            return false; //empty, or a later job already replaced this one
+
+        if (share.state.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            taskIndex = (int) next;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingPool::claimBack(Share& share, juce::uint32 jobGeneration, int& taskIndex) noexcept
+{
+    auto state = share.state.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto end = (state >> 16) & indexMask;
+        if ((juce::uint32) (state >> 32) != jobGeneration || (state & indexMask) >= end)
+            return false;
+
+        if (share.state.compare_exchange_weak(state, state - ((juce::uint64) 1 << 16), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            taskIndex = (int) end - 1;
+            return true;
+        }
+    }
+}
+
+void WorkStealingPool::runTask(int taskIndex) noexcept
+{
+    //the claim succeeded so this job can't finish (and be replaced) before we do
+    auto* task = currentTask.load(std::memory_order_relaxed);
+    task(currentContext.load(std::memory_order_relaxed), taskIndex);
+    tasksFinished.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    WorkStealingPool.h
+
+    Fans one period's worth of independent tasks out over a fixed set of
+    pinned real-time threads. Every participant, the calling thread included,
+    starts with its own contiguous share of the tasks and works through it
+    from the front. A participant that runs out steals from the back of the
+    others' shares, so a stream that happens to be expensive this period
+    doesn't hold its whole share hostage.
+
+    Each share is a single 64 bit word (generation | end | next) that owners
+    and thieves claim from with a compare-and-swap, as in ChannelWorkerPool.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class WorkStealingPool
+{
+public:
+    using Task = void (*)(void* context, int taskIndex);
+
+    /** numThreads counts the calling thread. Workers are pinned to firstCore + 1 onwards when pinThreads is set. */
+    WorkStealingPool(int numThreads, bool pinThreads, int firstCore = 0);
+    ~WorkStealingPool();
+
+    /** Runs task(context, 0 .. numTasks - 1) over the calling thread and the workers, returns once every task has finished.
+        Real-time safe, only ever called from one thread.
+    */
+    void run(Task task, void* context, int numTasks) noexcept;
+
+    int getNumThreads() const noexcept { return numParticipants; }
+    juce::uint64 getNumSteals() const noexcept { return steals.load(std::memory_order_relaxed); }
+
+    /** Pins the calling thread to one core, returns false if the platform wouldn't. */
+    static bool pinCurrentThread(int core);
+
+private:
+    class Worker;
+
+    struct alignas(64) Share //one cache line each, owners and thieves of different shares never contend
+    {
+        std::atomic<juce::uint64> state{ 0 }; //generation (upper 32 bits) | end (16 bits) | next (16 bits)
+    };
+
+    void work(int participant, juce::uint32 jobGeneration) noexcept;
+    bool claimFront(Share& share, juce::uint32 jobGeneration, int& taskIndex) noexcept;
+    bool claimBack(Share& share, juce::uint32 jobGeneration, int& taskIndex) noexcept;
+    void runTask(int taskIndex) noexcept;
+
+    const int numParticipants;
+    std::unique_ptr<Share[]> shares;
+    std::atomic<juce::uint32> generation{ 0 };
+    std::atomic<Task> currentTask{ nullptr };
+    std::atomic<void*> currentContext{ nullptr };
+    std::atomic<int> tasksFinished{ 0 };
+    std::atomic<juce::uint64> steals{ 0 };
+
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkStealingPool)
+};